@@ -1,28 +1,56 @@
 #include <iostream>
+#include <optional>
+#include <fcntl.h>
 #include <getopt.h>
 
 #include "Mint.h"
+#include "Collector.h"
+#include "Optimizer.h"
+#include "Memo.h"
+#include "Output.h"
+
+// Long options without a short equivalent
+enum long_only_opts { GC_THRESHOLD = 256, GC_STATS, LEX_THREADS, OPT_STATS, MEMOIZE, MEMO_STATS, OUTPUT_FD, FLUSH };
 
 auto helper() {
     std::cout << "Mint interpreter. Usage: \n" <<
-                 "-f, --file [FILE]   | Run a Mint script\n" <<
-                 "-a, --about         | About Mint\n" <<
-                 "-h, --help          | Show this helper\n"
+                 "-f, --file [FILE]              | Run a Mint script\n" <<
+                 "-e, --engine [tree|vm|closure] | Select the execution engine(default: tree)\n" <<
+                 "-O0, -O1                       | Disable or enable the optimiser(default: -O1)\n" <<
+                 "--opt-stats                    | Print optimiser statistics on exit\n" <<
+                 "--memoize [N]                  | Cache up to N results of each pure function(tree engine)\n" <<
+                 "--memo-stats                   | Print memoisation statistics on exit\n" <<
+                 "--gc-threshold [N]             | Allocations between two cycle collections(0 disables them)\n" <<
+                 "--gc-stats                     | Print cycle collector statistics on exit\n" <<
+                 "--lex-threads [N]              | Threads used to lex large scripts(default: one per core)\n" <<
+                 "--output-fd [N]                | Print to file descriptor N instead of the standard output\n" <<
+                 "--flush [line|block]           | Flush the output after every line or when the buffer is full\n"
+                 "                               | (default: line on a terminal, block otherwise)\n" <<
+                 "-a, --about                    | About Mint\n" <<
+                 "-h, --help                     | Show this helper\n"
                  "Run Mint without parameters to open the REPL." << std::endl;
 }
 
 int main(int argc, char **argv) {
-    if(argc > 3) {
-        std::cerr << "Error: too many arguments. Please use \"" << argv[0] << " --help\" to show the helper." << std::endl;
-        return 1;
-    }
-
     int opt;
-    const char * short_opts = "f:ah";
+    const char * short_opts = "f:e:O:ah";
     std::string file_name;
     auto execute_from_file = false;
+    auto print_gc_stats = false;
+    auto print_opt_stats = false;
+    auto print_memo_stats = false;
+    std::optional<flush_policy> flush;
     struct option long_opts[] = {
             {"file", required_argument, nullptr, 'f'},
+            {"engine", required_argument, nullptr, 'e'},
+            {"opt-stats", no_argument, nullptr, OPT_STATS},
+            {"memoize", required_argument, nullptr, MEMOIZE},
+            {"memo-stats", no_argument, nullptr, MEMO_STATS},
+            {"gc-threshold", required_argument, nullptr, GC_THRESHOLD},
+            {"gc-stats", no_argument, nullptr, GC_STATS},
+            {"lex-threads", required_argument, nullptr, LEX_THREADS},
+            {"output-fd", required_argument, nullptr, OUTPUT_FD},
+            {"flush", required_argument, nullptr, FLUSH},
             {"about", no_argument, nullptr, 'a'},
             {"help", no_argument, nullptr, 'h'},
             {nullptr, 0, nullptr, 0}
@@ -35,6 +63,79 @@ int main(int argc, char **argv) {
                 execute_from_file = true;
             }
             break;
+            case 'e': {
+                auto engine = std::string(optarg);
+                if(engine == "tree") Mint::set_engine(engine_type::INTERPRETER);
+                else if(engine == "vm") Mint::set_engine(engine_type::VM);
+                else if(engine == "closure") Mint::set_engine(engine_type::CLOSURE);
+                else {
+                    std::cerr << "Error: unknown engine \"" << engine << "\"." << std::endl;
+                    return 1;
+                }
+            }
+            break;
+            case 'O': {
+                auto level = std::string(optarg);
+                if(level == "0") Mint::set_optimization_level(0);
+                else if(level == "1") Mint::set_optimization_level(1);
+                else {
+                    std::cerr << "Error: unknown optimisation level \"" << level << "\"." << std::endl;
+                    return 1;
+                }
+            }
+            break;
+            case OPT_STATS: print_opt_stats = true; break;
+            case MEMOIZE: {
+                try {
+                    Memo::set_capacity(std::stoul(optarg));
+                } catch(const std::exception&) {
+                    std::cerr << "Error: invalid cache size \"" << optarg << "\"." << std::endl;
+                    return 1;
+                }
+            }
+            break;
+            case MEMO_STATS: print_memo_stats = true; break;
+            case GC_THRESHOLD: {
+                try {
+                    Collector::set_threshold(std::stoul(optarg));
+                } catch(const std::exception&) {
+                    std::cerr << "Error: invalid threshold \"" << optarg << "\"." << std::endl;
+                    return 1;
+                }
+            }
+            break;
+            case GC_STATS: print_gc_stats = true; break;
+            case LEX_THREADS: {
+                try {
+                    Mint::set_lexer_threads(std::stoul(optarg));
+                } catch(const std::exception&) {
+                    std::cerr << "Error: invalid thread count \"" << optarg << "\"." << std::endl;
+                    return 1;
+                }
+            }
+            break;
+            case OUTPUT_FD: {
+                int fd = -1;
+                try {
+                    fd = std::stoi(optarg);
+                } catch(const std::exception&) {}
+                if(fd < 0 || fcntl(fd, F_GETFD) == -1) {
+                    std::cerr << "Error: invalid file descriptor \"" << optarg << "\"." << std::endl;
+                    return 1;
+                }
+                Output::redirect(fd);
+            }
+            break;
+            case FLUSH: {
+                auto policy = std::string(optarg);
+                if(policy == "line") flush = flush_policy::LINE;
+                else if(policy == "block") flush = flush_policy::BLOCK;
+                else {
+                    std::cerr << "Error: unknown flush policy \"" << policy << "\"." << std::endl;
+                    return 1;
+                }
+            }
+            break;
             case 'a': {
                 std::cout << "Mint is an interpreted programming language written in C++.\n"
                           << "For further information, please refer to https://github.com/ice-bit/Mint\n"
@@ -45,12 +146,40 @@ int main(int argc, char **argv) {
         }
     }
 
+    if(optind < argc) {
+        std::cerr << "Error: too many arguments. Please use \"" << argv[0] << " --help\" to show the helper." << std::endl;
+        return 1;
+    }
+
+    // Redirecting the output picks the default policy of the new sink
+    if(flush.has_value()) Output::set_policy(*flush);
+
     auto ret = 0;
     if(execute_from_file)
         ret = Mint::run_file(file_name);
     else
         Mint::run_prompt();
 
+    if(print_opt_stats) {
+        const auto& stats = Optimizer::stats();
+        std::cerr << "Folded expressions: " << stats.folded << "\n"
+                  << "Propagated constants: " << stats.propagated << "\n"
+                  << "Pruned statements: " << stats.pruned << std::endl;
+    }
+
+    if(print_memo_stats) {
+        const auto& stats = Memo::stats();
+        std::cerr << "Memoised hits: " << stats.hits << "\n"
+                  << "Memoised misses: " << stats.misses << "\n"
+                  << "Evicted results: " << stats.evictions << std::endl;
+    }
+
+    if(print_gc_stats) {
+        const auto& stats = Collector::stats();
+        std::cerr << "Collections: " << stats.collections << "\n"
+                  << "Collected objects: " << stats.collected << "\n"
+                  << "Tracked objects: " << stats.tracked << std::endl;
+    }
 
     return ret;
-}
\ No newline at end of file
+}
@@ -0,0 +1,95 @@
+/*
+ * Mint interpreter
+ * Developed by Marco Cetica (c) 2022
+ * Released under GPLv3
+ *
+ */
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+ * Bump allocator for objects sharing the same lifetime. Objects are
+ * carved out of large blocks and never freed one by one: destroying
+ * the arena runs their destructors(newest first) and releases every
+ * block at once.
+ */
+class Arena {
+public:
+    Arena() = default;
+    Arena(const Arena&) = delete;
+    auto operator=(const Arena&) -> Arena& = delete;
+    Arena(Arena&& other) noexcept
+        : blocks(std::move(other.blocks)), cursor(std::exchange(other.cursor, nullptr)),
+          end(std::exchange(other.end, nullptr)), finalizers(std::exchange(other.finalizers, nullptr)) {};
+    auto operator=(Arena&& other) noexcept -> Arena& {
+        if(this != &other) {
+            release();
+            blocks = std::move(other.blocks);
+            cursor = std::exchange(other.cursor, nullptr);
+            end = std::exchange(other.end, nullptr);
+            finalizers = std::exchange(other.finalizers, nullptr);
+        }
+
+        return *this;
+    }
+    ~Arena() { release(); }
+
+    template<class T, class... Args>
+    auto make(Args&&... args) -> T* {
+        auto object = new(allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        if constexpr(!std::is_trivially_destructible_v<T>) {
+            auto destroy = [](void* ptr) { static_cast<T*>(ptr)->~T(); };
+            finalizers = new(allocate(sizeof(Finalizer), alignof(Finalizer))) Finalizer{destroy, object, finalizers};
+        }
+
+        return object;
+    }
+
+private:
+    struct Finalizer {
+        void (*destroy)(void*);
+        void* object;
+        Finalizer* next;
+    };
+
+    static constexpr size_t BLOCK_SIZE = 32 * 1024;
+
+    auto allocate(size_t size, size_t align) -> void* {
+        auto space = static_cast<size_t>(end - cursor);
+        void* ptr = cursor;
+        if(cursor == nullptr || std::align(align, size, ptr, space) == nullptr) {
+            // Objects larger than a block get a block of their own
+            auto block_size = std::max(BLOCK_SIZE, size + align);
+            blocks.emplace_back(new std::byte[block_size]);
+            cursor = blocks.back().get();
+            end = cursor + block_size;
+            space = block_size;
+            ptr = cursor;
+            std::align(align, size, ptr, space);
+        }
+
+        cursor = static_cast<std::byte*>(ptr) + size;
+
+        return ptr;
+    }
+
+    auto release() -> void {
+        for(auto finalizer = finalizers; finalizer != nullptr; finalizer = finalizer->next)
+            finalizer->destroy(finalizer->object);
+        finalizers = nullptr;
+        blocks.clear();
+        cursor = end = nullptr;
+    }
+
+    std::vector<std::unique_ptr<std::byte[]>> blocks;
+    std::byte* cursor = nullptr;
+    std::byte* end = nullptr;
+    // Destructors to run, newest object first
+    Finalizer* finalizers = nullptr;
+};
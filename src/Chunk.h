@@ -0,0 +1,75 @@
+/*
+ * Mint interpreter
+ * Developed by Marco Cetica (c) 2022
+ * Released under GPLv3
+ *
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Token.h"
+#include "Value.h"
+
+/*
+ * Instructions understood by the VM. Operands follow the opcode:
+ * constant, global and jump operands are 16 bits wide(big endian),
+ * local, upvalue and argument count operands are a single byte.
+ */
+enum class opcode : uint8_t {
+    CONSTANT, NIL, TRUE, FALSE, POP,
+    GET_LOCAL, SET_LOCAL, GET_UPVALUE, SET_UPVALUE,
+    GET_GLOBAL, SET_GLOBAL, DEFINE_GLOBAL,
+    EQUAL, NOT_EQUAL, GREATER, GREATER_EQUAL, LESS, LESS_EQUAL,
+    ADD, SUBTRACT, MULTIPLY, DIVIDE, MODULO,
+    BIT_AND, BIT_OR, XOR, LEFT_SHIFT, RIGHT_SHIFT,
+    NOT, NEGATE, BIT_NOT,
+    PRINT, JUMP, JUMP_IF_FALSE, LOOP,
+    CALL, TAIL_CALL, CLOSURE, CLOSE_UPVALUE, RETURN
+};
+
+class Chunk {
+public:
+    auto write(uint8_t byte, const Token* token) -> void {
+        code.push_back(byte);
+        tokens.push_back(token);
+    }
+
+    auto write(opcode op, const Token* token) -> void {
+        write(static_cast<uint8_t>(op), token);
+    }
+
+    auto add_constant(Value value) -> size_t {
+        constants.push_back(std::move(value));
+        return constants.size() - 1;
+    }
+
+    std::vector<uint8_t> code;
+    // Source token of every byte, used to report runtime errors.
+    // Instructions that cannot fail have no token.
+    std::vector<const Token*> tokens;
+    std::vector<Value> constants;
+};
+
+/*
+ * A compiled function. The chunk points to tokens owned by the
+ * syntax tree of the program that declared the function.
+ */
+class MintPrototype : public Object {
+public:
+    MintPrototype(std::string name, unsigned short arity)
+        : Object(object_type::PROTOTYPE), name(std::move(name)), arity(arity) {};
+    std::string to_string() override {
+        return name.empty() ? "<script>" : "<fn " + name + ">";
+    }
+
+    const std::string name;
+    const unsigned short arity;
+    unsigned int upvalue_count = 0;
+    // Most stack slots a call uses at once, counting the function itself,
+    // its arguments, its locals and its temporaries
+    size_t max_stack = 0;
+    Chunk chunk;
+};
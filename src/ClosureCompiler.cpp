@@ -0,0 +1,593 @@
+#include <array>
+#include <cmath>
+#include <functional>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include "ClosureCompiler.h"
+#include "Mint.h"
+#include "Natives.h"
+#include "Operators.h"
+#include "Output.h"
+#include "RuntimeError.h"
+
+#define UNUSED(x) (void)(x)
+
+// Maximum call depth, every call nests a few native frames
+constexpr auto MAX_CALL_DEPTH = 2048U;
+
+namespace {
+    // Arithmetic on either kind of number: integers go through the
+    // overflow checked operators
+    struct plus {
+        auto operator()(double a, double b) const -> Value { return a + b; }
+        auto operator()(int64_t a, int64_t b) const -> Value { return Operators::add(a, b); }
+    };
+    struct minus {
+        auto operator()(double a, double b) const -> Value { return a - b; }
+        auto operator()(int64_t a, int64_t b) const -> Value { return Operators::subtract(a, b); }
+    };
+    struct multiplies {
+        auto operator()(double a, double b) const -> Value { return a * b; }
+        auto operator()(int64_t a, int64_t b) const -> Value { return Operators::multiply(a, b); }
+    };
+    struct divides {
+        auto operator()(double a, double b) const -> Value { return a / b; }
+        auto operator()(int64_t a, int64_t b) const -> Value { return Operators::divide(a, b); }
+    };
+    struct modulo {
+        auto operator()(double a, double b) const -> Value { return std::fmod(a, b); }
+        auto operator()(int64_t a, int64_t b) const -> Value { return Operators::modulo(a, b); }
+    };
+    // Bitwise operators only have an integer fast path, doubles take the generic one
+    template<class Op>
+    struct integral {
+        auto operator()(double, double) const -> Value = delete;
+        auto operator()(int64_t a, int64_t b) const -> Value { return Op{}(a, b); }
+    };
+    struct shift_left {
+        auto operator()(int64_t a, int64_t b) const -> Value { return Operators::shift_left(a, b); }
+    };
+    struct shift_right {
+        auto operator()(int64_t a, int64_t b) const -> Value { return Operators::shift_right(a, b); }
+    };
+
+    // Native stack depth of the running program, shared by every compiled function
+    auto call_depth = 0U;
+
+    struct CallGuard {
+        explicit CallGuard(const Token& paren) {
+            if(call_depth == MAX_CALL_DEPTH) throw RuntimeError(paren, "Stack overflow.");
+            call_depth++;
+        }
+        ~CallGuard() { call_depth--; }
+        CallGuard(const CallGuard&) = delete;
+        CallGuard& operator=(const CallGuard&) = delete;
+    };
+
+    // Call left pending by a return in tail position. The caller makes it
+    // once the returning function has left its frame
+    struct TailCall {
+        Value callee;
+        std::shared_ptr<Environment> frame;
+    };
+    TailCall tail_call;
+
+    // Checks the callee and evaluates the arguments straight into the slots of its frame
+    auto open_frame(const Value& callee, const std::vector<ClosureCompiler::ExprClosure>& arguments,
+                    const ClosureCompiler::Env& env, const Token& paren) -> std::shared_ptr<Environment> {
+        if(!callee.is_object() || callee.as_object()->type != object_type::COMPILED_FUNCTION) {
+            for(const auto& argument : arguments) argument(env);
+            throw RuntimeError(paren, "Can only call functions and classes.");
+        }
+
+        auto function = callee.as_object<MintCompiledFunction>();
+        auto frame = std::make_shared<Environment>(function->closure);
+        for(const auto& argument : arguments)
+            frame->define(argument(env));
+
+        const auto& declaration = *function->code->declaration;
+        if(arguments.size() != declaration.params.size()) {
+            throw RuntimeError(paren, "Expected " +
+                std::to_string(declaration.params.size()) + " arguments but got " +
+                std::to_string(arguments.size()) + ".");
+        }
+
+        return frame;
+    }
+
+    // Natives take their arguments from a fixed array, with no frame at all
+    auto call_native(const MintNative& native, const std::vector<ClosureCompiler::ExprClosure>& arguments,
+                     const ClosureCompiler::Env& env, const Token& paren) -> Value {
+        std::array<Value, MintNative::MAX_ARITY> values;
+        auto count = 0U;
+        for(const auto& argument : arguments) {
+            auto value = argument(env);
+            if(count < values.size()) values[count] = std::move(value);
+            count++;
+        }
+
+        if(count != native.params) {
+            throw RuntimeError(paren, "Expected " +
+                std::to_string(native.params) + " arguments but got " +
+                std::to_string(count) + ".");
+        }
+
+        return native.function(values.data());
+    }
+}
+
+std::string MintCompiledFunction::to_string() {
+    return "<fn " + std::string(code->declaration->name.lexeme) + ">";
+}
+
+auto MintCompiledFunction::traverse(const Visitor& visit) -> void {
+    if(closure != nullptr) visit(closure.get());
+}
+
+auto MintCompiledFunction::clear() -> void {
+    closure.reset();
+}
+
+ClosureCompiler::ClosureCompiler() {
+    for(const auto& native : Natives::registry()) {
+        auto cell = global(Interner::symbol(native.as_object<MintNative>()->name));
+        cell->value = native;
+        cell->defined = true;
+    }
+}
+
+auto ClosureCompiler::interpret(const std::vector<Stmt*>& statements) -> void {
+    auto program = compile(statements);
+
+    try {
+        Value result;
+        for(const auto& statement : program)
+            if(statement(root, result)) break;
+    } catch(const RuntimeError& err) {
+        tail_call = TailCall{};
+        Mint::runtime_error(err);
+    }
+}
+
+auto ClosureCompiler::compile(Expr* expr) -> ExprClosure {
+    UNUSED(expr->accept(*this));
+    return std::move(expr_closure);
+}
+
+auto ClosureCompiler::compile(Stmt* stmt) -> StmtClosure {
+    stmt->accept(*this);
+    return std::move(stmt_closure);
+}
+
+auto ClosureCompiler::compile(const std::vector<Stmt*>& statements) -> std::vector<StmtClosure> {
+    std::vector<StmtClosure> closures;
+    closures.reserve(statements.size());
+    for(const auto& statement : statements)
+        closures.push_back(compile(statement));
+
+    return closures;
+}
+
+auto ClosureCompiler::global(Symbol name) -> Global* {
+    return &globals[name];
+}
+
+/*
+ * Calls k with an inlinable reader for the operand: local slots of the
+ * current environment and numeric constants are read directly, any
+ * other expression goes through its compiled closure.
+ */
+template<class K>
+auto ClosureCompiler::with_operand(Expr* expr, K&& k) -> ExprClosure {
+    if(auto variable = dynamic_cast<Variable*>(expr); variable && variable->resolved.depth == 0) {
+        auto slot = variable->resolved.slot;
+        return k([slot](const Env& env) -> const Value& { return env->get_at(0, slot); });
+    }
+
+    if(auto literal = dynamic_cast<Literal*>(expr); literal && literal->value.is_numeric()) {
+        auto value = literal->value;
+        return k([value](const Env&) -> const Value& { return value; });
+    }
+
+    auto closure = compile(expr);
+    return k([closure = std::move(closure)](const Env& env) -> Value { return closure(env); });
+}
+
+// Arithmetic, comparison and bitwise operators, specialised on the shape of both operands
+template<class Op>
+auto ClosureCompiler::numeric(Binary& expr) -> ExprClosure {
+    const auto& op = expr.op;
+
+    return with_operand(expr.left, [&](auto left) {
+        return with_operand(expr.right, [&](auto right) -> ExprClosure {
+            return [&op, left, right](const Env& env) -> Value {
+                auto a = left(env);
+                const auto& b = right(env);
+                if constexpr(std::is_invocable_v<Op, double, double>)
+                    if(a.is_number() && b.is_number()) return Op{}(a.as_number(), b.as_number());
+                if(a.is_integer() && b.is_integer()) return Op{}(a.as_integer(), b.as_integer());
+
+                return Operators::binary(op, a, b);
+            };
+        });
+    });
+}
+
+Value ClosureCompiler::visit_binary_expr(Binary& expr) {
+    switch(expr.op.type) {
+        case token_type::PLUS: expr_closure = numeric<plus>(expr); break;
+        case token_type::MINUS: expr_closure = numeric<minus>(expr); break;
+        case token_type::STAR: expr_closure = numeric<multiplies>(expr); break;
+        case token_type::SLASH: expr_closure = numeric<divides>(expr); break;
+        case token_type::MODULO: expr_closure = numeric<modulo>(expr); break;
+        case token_type::GREATER: expr_closure = numeric<std::greater<>>(expr); break;
+        case token_type::GREATER_EQUAL: expr_closure = numeric<std::greater_equal<>>(expr); break;
+        case token_type::LESS: expr_closure = numeric<std::less<>>(expr); break;
+        case token_type::LESS_EQUAL: expr_closure = numeric<std::less_equal<>>(expr); break;
+        case token_type::BIT_AND: expr_closure = numeric<integral<std::bit_and<int64_t>>>(expr); break;
+        case token_type::BIT_OR: expr_closure = numeric<integral<std::bit_or<int64_t>>>(expr); break;
+        case token_type::XOR: expr_closure = numeric<integral<std::bit_xor<int64_t>>>(expr); break;
+        case token_type::LEFT_SHIFT: expr_closure = numeric<integral<shift_left>>(expr); break;
+        case token_type::RIGHT_SHIFT: expr_closure = numeric<integral<shift_right>>(expr); break;
+        case token_type::EQUAL_EQUAL: {
+            auto left = compile(expr.left);
+            auto right = compile(expr.right);
+            expr_closure = [left, right](const Env& env) -> Value {
+                auto a = left(env);
+                return Operators::is_equal(a, right(env));
+            };
+        }
+        break;
+        case token_type::BANG_EQUAL: {
+            auto left = compile(expr.left);
+            auto right = compile(expr.right);
+            expr_closure = [left, right](const Env& env) -> Value {
+                auto a = left(env);
+                return !Operators::is_equal(a, right(env));
+            };
+        }
+        break;
+        default: {
+            auto left = compile(expr.left);
+            auto right = compile(expr.right);
+            const auto& op = expr.op;
+            expr_closure = [left, right, &op](const Env& env) -> Value {
+                auto a = left(env);
+                return Operators::binary(op, a, right(env));
+            };
+        }
+    }
+
+    return nullptr;
+}
+
+Value ClosureCompiler::visit_grouping_expr(Grouping& expr) {
+    expr_closure = compile(expr.expr);
+    return nullptr;
+}
+
+Value ClosureCompiler::visit_literal_expr(Literal& expr) {
+    expr_closure = [value = expr.value](const Env&) -> Value { return value; };
+    return nullptr;
+}
+
+Value ClosureCompiler::visit_logical_expr(Logical& expr) {
+    auto left = compile(expr.left);
+    auto right = compile(expr.right);
+
+    if(expr.op.type == token_type::OR) {
+        expr_closure = [left, right](const Env& env) -> Value {
+            auto value = left(env);
+            return Operators::is_truthy(value) ? value : right(env);
+        };
+    } else {
+        expr_closure = [left, right](const Env& env) -> Value {
+            auto value = left(env);
+            return Operators::is_truthy(value) ? right(env) : value;
+        };
+    }
+
+    return nullptr;
+}
+
+Value ClosureCompiler::visit_unary_expr(Unary& expr) {
+    auto right = compile(expr.right);
+    const auto& op = expr.op;
+
+    switch(op.type) {
+        case token_type::BANG:
+            expr_closure = [right](const Env& env) -> Value { return !Operators::is_truthy(right(env)); };
+            break;
+        case token_type::MINUS:
+            expr_closure = [right, &op](const Env& env) -> Value {
+                auto value = right(env);
+                if(value.is_number()) return -value.as_number();
+                if(value.is_integer()) return Operators::negate(value.as_integer());
+                return Operators::unary(op, value);
+            };
+            break;
+        default:
+            expr_closure = [right, &op](const Env& env) -> Value { return Operators::unary(op, right(env)); };
+    }
+
+    return nullptr;
+}
+
+Value ClosureCompiler::visit_variable_expr(Variable& expr) {
+    const auto& resolved = expr.resolved;
+    auto slot = resolved.slot;
+
+    if(resolved.is_global()) {
+        auto cell = global(expr.name.symbol);
+        const auto& name = expr.name;
+        expr_closure = [cell, &name](const Env&) -> Value {
+            if(!cell->defined) throw RuntimeError(name, "Undefined variable '" + std::string(name.lexeme) + "'");
+            return cell->value;
+        };
+    } else if(resolved.depth == 0) {
+        expr_closure = [slot](const Env& env) -> Value { return env->get_at(0, slot); };
+    } else if(resolved.depth == 1) {
+        expr_closure = [slot](const Env& env) -> Value { return env->get_at(1, slot); };
+    } else {
+        auto depth = static_cast<unsigned int>(resolved.depth);
+        expr_closure = [depth, slot](const Env& env) -> Value { return env->get_at(depth, slot); };
+    }
+
+    return nullptr;
+}
+
+Value ClosureCompiler::visit_assign_expr(Assign& expr) {
+    auto value = compile(expr.value);
+    const auto& resolved = expr.resolved;
+    auto slot = resolved.slot;
+
+    if(resolved.is_global()) {
+        auto cell = global(expr.name.symbol);
+        const auto& name = expr.name;
+        expr_closure = [cell, &name, value](const Env& env) -> Value {
+            auto result = value(env);
+            if(!cell->defined) throw RuntimeError(name, "Undefined variable '" + std::string(name.lexeme) + "'");
+            cell->value = result;
+            return result;
+        };
+    } else if(resolved.depth == 0) {
+        expr_closure = [slot, value](const Env& env) -> Value {
+            auto result = value(env);
+            env->assign_at(0, slot, result);
+            return result;
+        };
+    } else {
+        auto depth = static_cast<unsigned int>(resolved.depth);
+        expr_closure = [depth, slot, value](const Env& env) -> Value {
+            auto result = value(env);
+            env->assign_at(depth, slot, result);
+            return result;
+        };
+    }
+
+    return nullptr;
+}
+
+Value ClosureCompiler::visit_call_expr(Call& expr) {
+    auto callee = compile(expr.callee);
+    std::vector<ExprClosure> arguments;
+    arguments.reserve(expr.arguments.size());
+    for(const auto& argument : expr.arguments)
+        arguments.push_back(compile(argument));
+    const auto& paren = expr.paren;
+
+    expr_closure = [callee, arguments, &paren](const Env& env) -> Value {
+        auto value = callee(env);
+        if(value.is_native())
+            return call_native(*value.as_object<MintNative>(), arguments, env, paren);
+        auto frame = open_frame(value, arguments, env, paren);
+
+        CallGuard guard(paren);
+        Value result;
+        while(true) {
+            for(const auto& statement : value.as_object<MintCompiledFunction>()->code->body)
+                if(statement(frame, result)) break;
+
+            // Calls in tail position reuse this native frame
+            if(tail_call.frame == nullptr) return result;
+            value = std::move(tail_call.callee);
+            frame = std::move(tail_call.frame);
+        }
+    };
+
+    return nullptr;
+}
+
+void ClosureCompiler::visit_block_stmt(Block& stmt) {
+    if(!stmt.scoped) {
+        stmt_closure = [statements = compile(stmt.statements)](const Env& env, Value& result) {
+            for(const auto& statement : statements)
+                if(statement(env, result)) return true;
+
+            return false;
+        };
+        return;
+    }
+
+    scope_depth++;
+    auto statements = compile(stmt.statements);
+    scope_depth--;
+
+    stmt_closure = [statements](const Env& env, Value& result) {
+        auto scope = std::make_shared<Environment>(env);
+        for(const auto& statement : statements)
+            if(statement(scope, result)) return true;
+
+        return false;
+    };
+}
+
+void ClosureCompiler::visit_expression_stmt(Expression& stmt) {
+    stmt_closure = [expression = compile(stmt.expression)](const Env& env, Value&) {
+        expression(env);
+        return false;
+    };
+}
+
+void ClosureCompiler::visit_print_stmt(Print& stmt) {
+    stmt_closure = [expression = compile(stmt.expression)](const Env& env, Value&) {
+        Output::print(expression(env));
+        return false;
+    };
+}
+
+void ClosureCompiler::visit_variable_stmt(Var& stmt) {
+    ExprClosure initializer = [](const Env&) -> Value { return nullptr; };
+    if(stmt.initializer != nullptr) initializer = compile(stmt.initializer);
+
+    if(scope_depth == 0) {
+        stmt_closure = [cell = global(stmt.name.symbol), initializer](const Env& env, Value&) {
+            cell->value = initializer(env);
+            cell->defined = true;
+            return false;
+        };
+    } else {
+        // Locals are appended in declaration order, which matches the
+        // slot the resolver assigned to them
+        stmt_closure = [initializer](const Env& env, Value&) {
+            env->define(initializer(env));
+            return false;
+        };
+    }
+}
+
+void ClosureCompiler::visit_if_stmt(If& stmt) {
+    auto condition = compile(stmt.condition);
+    auto then_branch = compile(stmt.then_branch);
+
+    if(stmt.else_branch == nullptr) {
+        stmt_closure = [condition, then_branch](const Env& env, Value& result) {
+            return Operators::is_truthy(condition(env)) && then_branch(env, result);
+        };
+    } else {
+        stmt_closure = [condition, then_branch, else_branch = compile(stmt.else_branch)](const Env& env, Value& result) {
+            return Operators::is_truthy(condition(env)) ? then_branch(env, result) : else_branch(env, result);
+        };
+    }
+}
+
+void ClosureCompiler::visit_while_stmt(While& stmt) {
+    auto condition = compile(stmt.condition);
+    if(auto loop = CountedLoop::match(stmt)) {
+        compile_counted_loop(*loop, std::move(condition));
+        return;
+    }
+    auto body = compile(stmt.body);
+
+    stmt_closure = [condition, body](const Env& env, Value& result) {
+        while(Operators::is_truthy(condition(env)))
+            if(body(env, result)) return true;
+
+        return false;
+    };
+}
+
+auto ClosureCompiler::compile_counted_loop(const CountedLoop& loop, ExprClosure condition) -> void {
+    auto limit = compile(loop.limit);
+    auto body = compile(loop.body);
+    auto increment = compile(loop.increment);
+
+    stmt_closure = [loop, condition, limit, body, increment](const Env& env, Value& result) {
+        auto run_body = [&]() {
+            for(const auto& statement : body)
+                if(statement(env, result)) return true;
+
+            return false;
+        };
+
+        // Runs until the loop ends(returning whether it did by a return
+        // statement) or until it must go on as a plain while statement
+        auto count = [&](auto counter, decltype(counter) step) -> std::optional<bool> {
+            while(true) {
+                if(!loop.test(counter, limit(env))) return false;
+                if(run_body()) return true;
+
+                const auto& current = env->get_at(loop.counter.depth, loop.counter.slot);
+                if(!CountedLoop::holds(current, counter) || !CountedLoop::advance(counter, step)) {
+                    // The body assigned the counter, or it would overflow:
+                    // finish this iteration as written
+                    increment(env, result);
+                    return std::nullopt;
+                }
+
+                env->assign_at(loop.counter.depth, loop.counter.slot, counter);
+            }
+        };
+
+        const auto& start = env->get_at(loop.counter.depth, loop.counter.slot);
+        std::optional<bool> done;
+        if(start.is_integer() && loop.step.is_integer()) done = count(start.as_integer(), loop.step.as_integer());
+        else if(start.is_number()) done = count(start.as_number(), loop.step.to_number());
+        if(done.has_value()) return *done;
+
+        while(Operators::is_truthy(condition(env))) {
+            if(run_body()) return true;
+            increment(env, result);
+        }
+
+        return false;
+    };
+}
+
+void ClosureCompiler::visit_function_stmt(Function& stmt) {
+    auto code = std::make_shared<CompiledCode>();
+    code->declaration = &stmt;
+
+    auto is_global = scope_depth == 0;
+    scope_depth++;
+    code->body = compile(stmt.body);
+    scope_depth--;
+
+    if(is_global) {
+        stmt_closure = [cell = global(stmt.name.symbol), code](const Env& env, Value&) {
+            cell->value = Value(new MintCompiledFunction(code, env));
+            cell->defined = true;
+            return false;
+        };
+    } else {
+        stmt_closure = [code](const Env& env, Value&) {
+            env->define(Value(new MintCompiledFunction(code, env)));
+            return false;
+        };
+    }
+}
+
+void ClosureCompiler::visit_return_stmt(Return& stmt) {
+    if(stmt.tail) {
+        // Only prepare the call, the caller makes it
+        auto& call = static_cast<Call&>(*stmt.value);
+        auto callee = compile(call.callee);
+        std::vector<ExprClosure> arguments;
+        arguments.reserve(call.arguments.size());
+        for(const auto& argument : call.arguments)
+            arguments.push_back(compile(argument));
+        const auto& paren = call.paren;
+
+        stmt_closure = [callee, arguments, &paren](const Env& env, Value& result) {
+            auto value = callee(env);
+            if(value.is_native()) {
+                result = call_native(*value.as_object<MintNative>(), arguments, env, paren);
+                return true;
+            }
+            auto frame = open_frame(value, arguments, env, paren);
+            tail_call = TailCall{std::move(value), std::move(frame)};
+            return true;
+        };
+    } else if(stmt.value == nullptr) {
+        stmt_closure = [](const Env&, Value& result) {
+            result = nullptr;
+            return true;
+        };
+    } else {
+        stmt_closure = [value = compile(stmt.value)](const Env& env, Value& result) {
+            result = value(env);
+            return true;
+        };
+    }
+}
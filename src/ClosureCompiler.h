@@ -0,0 +1,100 @@
+/*
+ * Mint interpreter
+ * Developed by Marco Cetica (c) 2022
+ * Released under GPLv3
+ *
+ */
+#pragma once
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Stmt.h"
+#include "Environment.h"
+#include "Collector.h"
+#include "CountedLoop.h"
+
+/*
+ * Execution engine that walks the resolved AST once and turns every
+ * node into a pre-bound C++ callable. Running the program then simply
+ * invokes the closures, with no visitor dispatch per node. Locals live
+ * in the same slot environments used by the tree-walking interpreter,
+ * globals are bound to their storage cell at compile time.
+ */
+class ClosureCompiler : public ExprVisitor, public StmtVisitor {
+public:
+    using Env = std::shared_ptr<Environment>;
+    // Evaluates an expression in the given environment
+    using ExprClosure = std::function<Value(const Env&)>;
+    // Executes a statement in the given environment. Returns true
+    // when a return statement was executed, the returned value is
+    // stored in the second argument
+    using StmtClosure = std::function<bool(const Env&, Value&)>;
+
+    ClosureCompiler();
+    auto interpret(const std::vector<Stmt*>& statements) -> void;
+    // Stmt abstract class
+    void visit_block_stmt(Block& stmt) override;
+    void visit_expression_stmt(Expression& stmt) override;
+    void visit_function_stmt(Function& stmt) override;
+    void visit_if_stmt(If& stmt) override;
+    void visit_print_stmt(Print& stmt) override;
+    void visit_return_stmt(Return& stmt) override;
+    void visit_variable_stmt(Var& stmt) override;
+    void visit_while_stmt(While& stmt) override;
+    // Expr abstract class
+    Value visit_assign_expr(Assign& expr) override;
+    Value visit_binary_expr(Binary& expr) override;
+    Value visit_call_expr(Call& expr) override;
+    Value visit_grouping_expr(Grouping& expr) override;
+    Value visit_literal_expr(Literal& expr) override;
+    Value visit_logical_expr(Logical& expr) override;
+    Value visit_unary_expr(Unary& expr) override;
+    Value visit_variable_expr(Variable& expr) override;
+
+private:
+    struct Global {
+        Value value;
+        bool defined = false;
+    };
+
+    auto compile(Expr* expr) -> ExprClosure;
+    auto compile(Stmt* stmt) -> StmtClosure;
+    auto compile(const std::vector<Stmt*>& statements) -> std::vector<StmtClosure>;
+    auto global(Symbol name) -> Global*;
+    template<class Op>
+    auto numeric(Binary& expr) -> ExprClosure;
+    auto compile_counted_loop(const CountedLoop& loop, ExprClosure condition) -> void;
+    template<class K>
+    auto with_operand(Expr* expr, K&& k) -> ExprClosure;
+
+    ExprClosure expr_closure;
+    StmtClosure stmt_closure;
+    // Number of enclosing blocks and functions, zero at top level
+    unsigned int scope_depth = 0;
+    // Node based, so the address of every cell is stable
+    std::unordered_map<Symbol, Global> globals;
+    Env root{new Environment};
+};
+
+/*
+ * Body of a function compiled to closures. The closures point to
+ * tokens owned by the declaration.
+ */
+struct CompiledCode {
+    const Function* declaration;
+    std::vector<ClosureCompiler::StmtClosure> body;
+};
+
+class MintCompiledFunction : public CollectableObject<Object> {
+public:
+    MintCompiledFunction(std::shared_ptr<const CompiledCode> code, std::shared_ptr<Environment> closure)
+        : CollectableObject(object_type::COMPILED_FUNCTION), code(std::move(code)), closure(std::move(closure)) {};
+    std::string to_string() override;
+    auto traverse(const Visitor& visit) -> void override;
+    auto clear() -> void override;
+
+    const std::shared_ptr<const CompiledCode> code;
+    std::shared_ptr<Environment> closure;
+};
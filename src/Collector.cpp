@@ -0,0 +1,100 @@
+#include <algorithm>
+#include <vector>
+#include "Collector.h"
+
+// Marks objects reachable from outside the heap during a collection
+constexpr long REACHABLE = -1;
+
+Collectable* Collector::objects = nullptr;
+size_t Collector::threshold = Collector::DEFAULT_THRESHOLD;
+size_t Collector::survivors = 0;
+CollectorStats Collector::statistics;
+
+Collectable::Collectable() {
+    Collector::track(this);
+}
+
+Collectable::~Collectable() {
+    Collector::untrack(this);
+}
+
+auto Collector::track(Collectable* object) -> void {
+    // The new object is not linked yet, so it is never mistaken for garbage
+    if(threshold != 0 && ++statistics.allocations >= std::max(threshold, survivors))
+        collect();
+
+    object->next = objects;
+    if(objects != nullptr) objects->prev = object;
+    objects = object;
+    statistics.tracked++;
+}
+
+auto Collector::untrack(Collectable* object) -> void {
+    if(object->prev != nullptr) object->prev->next = object->next;
+    else objects = object->next;
+    if(object->next != nullptr) object->next->prev = object->prev;
+    statistics.tracked--;
+}
+
+auto Collector::collect() -> size_t {
+    statistics.collections++;
+    statistics.allocations = 0;
+
+    // Subtract the references coming from tracked objects
+    for(auto object = objects; object != nullptr; object = object->next)
+        object->gc_refs = object->references();
+    for(auto object = objects; object != nullptr; object = object->next)
+        object->traverse([](Collectable* target) { target->gc_refs--; });
+
+    // Objects with references left are reachable, and so is whatever they reference
+    std::vector<Collectable*> pending;
+    for(auto object = objects; object != nullptr; object = object->next) {
+        if(object->gc_refs > 0) {
+            object->gc_refs = REACHABLE;
+            pending.push_back(object);
+        }
+    }
+    while(!pending.empty()) {
+        auto object = pending.back();
+        pending.pop_back();
+        object->traverse([&pending](Collectable* target) {
+            if(target->gc_refs != REACHABLE) {
+                target->gc_refs = REACHABLE;
+                pending.push_back(target);
+            }
+        });
+    }
+
+    // Break the cycles of the unreachable objects, keeping all of them
+    // alive until every cycle is broken
+    std::vector<Collectable*> garbage;
+    std::vector<std::shared_ptr<void>> pins;
+    for(auto object = objects; object != nullptr; object = object->next) {
+        if(object->gc_refs != REACHABLE) {
+            garbage.push_back(object);
+            pins.push_back(object->pin());
+        }
+    }
+    for(auto object : garbage)
+        object->clear();
+    pins.clear();
+
+    statistics.collected += garbage.size();
+    survivors = statistics.tracked;
+
+    return garbage.size();
+}
+
+auto Collector::set_threshold(size_t threshold) -> void {
+    Collector::threshold = threshold;
+}
+
+auto Collector::stats() -> const CollectorStats& {
+    return statistics;
+}
+
+auto Collector::visit(const Value& value, const Collectable::Visitor& visit) -> void {
+    if(!value.is_object()) return;
+    if(auto object = value.as_object()->collectable(); object != nullptr)
+        visit(object);
+}
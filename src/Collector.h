@@ -0,0 +1,96 @@
+/*
+ * Mint interpreter
+ * Developed by Marco Cetica (c) 2022
+ * Released under GPLv3
+ *
+ */
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include "Value.h"
+
+/*
+ * Runtime data that can take part in a reference cycle: environments
+ * and the functions closing over them. Reference counting alone never
+ * frees a cycle, so every collectable is tracked by the Collector.
+ */
+class Collectable {
+public:
+    using Visitor = std::function<void(Collectable*)>;
+
+    Collectable();
+    Collectable(const Collectable&) = delete;
+    auto operator=(const Collectable&) -> Collectable& = delete;
+    virtual ~Collectable();
+
+    // Number of strong references to this object
+    [[nodiscard]] virtual auto references() const -> long = 0;
+    // Calls visit on every collectable this object holds a reference to
+    virtual auto traverse(const Visitor& visit) -> void = 0;
+    // Keeps this object alive until the returned handle is destroyed
+    virtual auto pin() -> std::shared_ptr<void> = 0;
+    // Drops every reference held by this object
+    virtual auto clear() -> void = 0;
+
+private:
+    friend class Collector;
+    Collectable* prev = nullptr;
+    Collectable* next = nullptr;
+    long gc_refs = 0;
+};
+
+// A reference counted runtime object that is also collectable
+template<class Base>
+class CollectableObject : public Base, public Collectable {
+public:
+    using Base::Base;
+    auto collectable() -> Collectable* override { return this; }
+    [[nodiscard]] auto references() const -> long override { return this->ref_count; }
+    auto pin() -> std::shared_ptr<void> override { return std::make_shared<Value>(Value(this)); }
+};
+
+struct CollectorStats {
+    size_t collections = 0;
+    // Objects freed by the collector
+    size_t collected = 0;
+    // Live collectables
+    size_t tracked = 0;
+    // Collectables allocated since the last collection
+    size_t allocations = 0;
+};
+
+/*
+ * Cycle collector working on top of reference counts(trial deletion).
+ * The references held by tracked objects are subtracted from the count
+ * of their targets: objects with references left are held from outside
+ * the heap(the native stack, globals, the VM stack), and so is everything
+ * they reference. The remaining objects are only referenced by each other,
+ * they are freed by clearing them.
+ * A collection starts once enough collectables have been allocated since
+ * the last one. The trigger grows with the number of survivors, so the
+ * cost of collecting stays proportional to the allocations.
+ */
+class Collector {
+public:
+    // Default number of allocations between two collections
+    static constexpr size_t DEFAULT_THRESHOLD = 1000;
+
+    static auto collect() -> size_t;
+    // A threshold of zero disables automatic collections
+    static auto set_threshold(size_t threshold) -> void;
+    static auto stats() -> const CollectorStats&;
+    // Calls visit on the collectable the value refers to, if any
+    static auto visit(const Value& value, const Collectable::Visitor& visit) -> void;
+
+private:
+    friend class Collectable;
+    static auto track(Collectable* object) -> void;
+    static auto untrack(Collectable* object) -> void;
+
+    static Collectable* objects;
+    static size_t threshold;
+    // Objects that survived the last collection
+    static size_t survivors;
+    static CollectorStats statistics;
+};
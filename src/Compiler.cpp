@@ -0,0 +1,453 @@
+#include <algorithm>
+#include <limits>
+#include "Compiler.h"
+#include "VM.h"
+#include "Mint.h"
+
+namespace {
+    // Slots an instruction pushes(or pops, if negative), not counting call arguments
+    auto stack_effect(opcode op) -> int {
+        switch(op) {
+            case opcode::CONSTANT: case opcode::NIL: case opcode::TRUE: case opcode::FALSE:
+            case opcode::GET_LOCAL: case opcode::GET_UPVALUE: case opcode::GET_GLOBAL:
+            case opcode::CLOSURE:
+                return 1;
+            case opcode::SET_LOCAL: case opcode::SET_UPVALUE: case opcode::SET_GLOBAL:
+            case opcode::NOT: case opcode::NEGATE: case opcode::BIT_NOT:
+            case opcode::JUMP: case opcode::JUMP_IF_FALSE: case opcode::LOOP:
+            case opcode::CALL: case opcode::TAIL_CALL:
+                return 0;
+            default:
+                return -1;
+        }
+    }
+}
+
+auto Compiler::compile(const std::vector<Stmt*>& statements) -> Value {
+    auto script = Value(new MintPrototype("", 0));
+    states.push_back(FunctionState{script.as_object<MintPrototype>(), {}, {}, 0, 0, {}});
+    // Slot zero of every frame holds the function being executed
+    states.back().locals.push_back(Local{nullptr, 0, false});
+    grow_stack(1);
+
+    for(const auto& stmt : statements)
+        compile(stmt);
+
+    emit(opcode::NIL);
+    emit(opcode::RETURN);
+    states.pop_back();
+
+    if(had_error) return nullptr;
+
+    return script;
+}
+
+auto Compiler::compile(Stmt* stmt) -> void {
+    stmt->accept(*this);
+}
+
+auto Compiler::compile(Expr* expr) -> void {
+    expr->accept(*this);
+}
+
+auto Compiler::compile_function(Function* function) -> void {
+    auto arity = static_cast<unsigned short>(function->params.size());
+    auto prototype = Value(new MintPrototype(std::string(function->name.lexeme), arity));
+    states.push_back(FunctionState{prototype.as_object<MintPrototype>(), {}, {}, 1, 0, {}});
+    states.back().locals.push_back(Local{nullptr, 0, false});
+    grow_stack(arity + 1);
+
+    for(const auto& param : function->params)
+        add_local(param);
+    for(const auto& stmt : function->body)
+        compile(stmt);
+
+    emit(opcode::NIL);
+    emit(opcode::RETURN);
+
+    auto upvalues = std::move(states.back().upvalues);
+    prototype.as_object<MintPrototype>()->upvalue_count = upvalues.size();
+    states.pop_back();
+
+    auto index = chunk().add_constant(prototype);
+    if(index > std::numeric_limits<uint16_t>::max())
+        error("Too many constants in one chunk.");
+    emit_short(opcode::CLOSURE, static_cast<uint16_t>(index), &function->name);
+    for(const auto& upvalue : upvalues) {
+        chunk().write(upvalue.is_local ? 1 : 0, nullptr);
+        chunk().write(upvalue.index, nullptr);
+    }
+}
+
+auto Compiler::chunk() -> Chunk& {
+    return states.back().function->chunk;
+}
+
+auto Compiler::emit(opcode op, const Token* token) -> void {
+    if(token != nullptr) last_token = token;
+    chunk().write(op, token);
+    grow_stack(stack_effect(op));
+}
+
+auto Compiler::emit(opcode op, uint8_t operand, const Token* token) -> void {
+    emit(op, token);
+    chunk().write(operand, token);
+    // A call leaves its result in the slot of the callee
+    if(op == opcode::CALL || op == opcode::TAIL_CALL) grow_stack(-operand);
+}
+
+auto Compiler::grow_stack(int count) -> void {
+    auto& state = states.back();
+    state.stack_depth += count;
+    state.function->max_stack = std::max(state.function->max_stack, static_cast<size_t>(state.stack_depth));
+}
+
+auto Compiler::emit_short(opcode op, uint16_t operand, const Token* token) -> void {
+    emit(op, token);
+    chunk().write(static_cast<uint8_t>((operand >> 8) & 0xff), token);
+    chunk().write(static_cast<uint8_t>(operand & 0xff), token);
+}
+
+auto Compiler::emit_jump(opcode op) -> size_t {
+    emit_short(op, 0xffff);
+    auto offset = chunk().code.size() - 2;
+    states.back().jump_depths[offset] = states.back().stack_depth;
+
+    return offset;
+}
+
+auto Compiler::patch_jump(size_t offset) -> void {
+    // Skip the two bytes of the operand itself
+    auto jump = chunk().code.size() - offset - 2;
+    if(jump > std::numeric_limits<uint16_t>::max())
+        error("Too much code to jump over.");
+
+    chunk().code[offset] = static_cast<uint8_t>((jump >> 8) & 0xff);
+    chunk().code[offset + 1] = static_cast<uint8_t>(jump & 0xff);
+
+    // The target is reached with the stack of the jump, or the one falling
+    // through to it, whichever is deeper
+    auto& state = states.back();
+    auto depth = state.jump_depths.find(offset);
+    state.stack_depth = std::max(state.stack_depth, depth->second);
+    state.jump_depths.erase(depth);
+}
+
+auto Compiler::emit_loop(size_t loop_start) -> void {
+    // Jump back over the LOOP instruction too
+    auto offset = chunk().code.size() - loop_start + 3;
+    if(offset > std::numeric_limits<uint16_t>::max())
+        error("Loop body too large.");
+
+    emit_short(opcode::LOOP, static_cast<uint16_t>(offset));
+}
+
+auto Compiler::emit_constant(Value value) -> void {
+    auto index = chunk().add_constant(std::move(value));
+    if(index > std::numeric_limits<uint16_t>::max())
+        error("Too many constants in one chunk.");
+
+    emit_short(opcode::CONSTANT, static_cast<uint16_t>(index));
+}
+
+auto Compiler::begin_scope() -> void {
+    states.back().scope_depth++;
+}
+
+auto Compiler::end_scope() -> void {
+    auto& state = states.back();
+    state.scope_depth--;
+
+    while(!state.locals.empty() && state.locals.back().depth > state.scope_depth) {
+        emit(state.locals.back().captured ? opcode::CLOSE_UPVALUE : opcode::POP);
+        state.locals.pop_back();
+    }
+}
+
+auto Compiler::error(const std::string& msg) -> void {
+    if(last_token != nullptr) Mint::error(*last_token, msg);
+    else Mint::error(0, msg);
+    had_error = true;
+}
+
+auto Compiler::add_local(const Token& name) -> void {
+    auto& state = states.back();
+    if(state.locals.size() > std::numeric_limits<uint8_t>::max()) {
+        last_token = &name;
+        error("Too many local variables in function.");
+        return;
+    }
+
+    state.locals.push_back(Local{name.symbol, state.scope_depth, false});
+}
+
+auto Compiler::global_slot(const Token& name) -> uint16_t {
+    return vm.global_slot(name.symbol);
+}
+
+auto Compiler::resolve_local(size_t state, Symbol name) -> int {
+    const auto& locals = states[state].locals;
+    // Slot zero is the function itself and has no name
+    for(auto i = static_cast<int>(locals.size()) - 1; i > 0; i--)
+        if(locals[i].name == name) return i;
+
+    return -1;
+}
+
+auto Compiler::resolve_upvalue(size_t state, Symbol name) -> int {
+    if(state == 0) return -1;
+
+    auto local = resolve_local(state - 1, name);
+    if(local != -1) {
+        states[state - 1].locals[local].captured = true;
+        return add_upvalue(state, static_cast<uint8_t>(local), true, name);
+    }
+
+    auto upvalue = resolve_upvalue(state - 1, name);
+    if(upvalue != -1)
+        return add_upvalue(state, static_cast<uint8_t>(upvalue), false, name);
+
+    return -1;
+}
+
+auto Compiler::add_upvalue(size_t state, uint8_t index, bool is_local, Symbol name) -> int {
+    auto& upvalues = states[state].upvalues;
+    for(auto i = 0UL; i < upvalues.size(); i++)
+        if(upvalues[i].index == index && upvalues[i].is_local == is_local) return static_cast<int>(i);
+
+    if(upvalues.size() > std::numeric_limits<uint8_t>::max()) {
+        error("Too many closure variables in function '" + std::string(name->chars()) + "'.");
+        return 0;
+    }
+
+    upvalues.push_back(Upvalue{index, is_local});
+
+    return static_cast<int>(upvalues.size() - 1);
+}
+
+auto Compiler::emit_get(const Token& name, const Resolution& resolved) -> void {
+    auto current = states.size() - 1;
+
+    if(!resolved.is_global()) {
+        auto slot = resolve_local(current, name.symbol);
+        if(slot != -1) {
+            emit(opcode::GET_LOCAL, static_cast<uint8_t>(slot), &name);
+            return;
+        }
+        auto upvalue = resolve_upvalue(current, name.symbol);
+        if(upvalue != -1) {
+            emit(opcode::GET_UPVALUE, static_cast<uint8_t>(upvalue), &name);
+            return;
+        }
+    }
+
+    emit_short(opcode::GET_GLOBAL, global_slot(name), &name);
+}
+
+auto Compiler::emit_set(const Token& name, const Resolution& resolved) -> void {
+    auto current = states.size() - 1;
+
+    if(!resolved.is_global()) {
+        auto slot = resolve_local(current, name.symbol);
+        if(slot != -1) {
+            emit(opcode::SET_LOCAL, static_cast<uint8_t>(slot), &name);
+            return;
+        }
+        auto upvalue = resolve_upvalue(current, name.symbol);
+        if(upvalue != -1) {
+            emit(opcode::SET_UPVALUE, static_cast<uint8_t>(upvalue), &name);
+            return;
+        }
+    }
+
+    emit_short(opcode::SET_GLOBAL, global_slot(name), &name);
+}
+
+void Compiler::visit_block_stmt(Block& stmt) {
+    begin_scope();
+    for(const auto& statement : stmt.statements)
+        compile(statement);
+    end_scope();
+}
+
+void Compiler::visit_expression_stmt(Expression& stmt) {
+    compile(stmt.expression);
+    emit(opcode::POP);
+}
+
+void Compiler::visit_function_stmt(Function& stmt) {
+    if(states.back().scope_depth == 0) {
+        compile_function(&stmt);
+        emit_short(opcode::DEFINE_GLOBAL, global_slot(stmt.name), &stmt.name);
+        return;
+    }
+
+    // Declare the local first so that the function can refer to itself
+    add_local(stmt.name);
+    compile_function(&stmt);
+}
+
+void Compiler::visit_if_stmt(If& stmt) {
+    compile(stmt.condition);
+
+    auto then_jump = emit_jump(opcode::JUMP_IF_FALSE);
+    emit(opcode::POP);
+    compile(stmt.then_branch);
+
+    auto else_jump = emit_jump(opcode::JUMP);
+    patch_jump(then_jump);
+    emit(opcode::POP);
+    if(stmt.else_branch != nullptr) compile(stmt.else_branch);
+    patch_jump(else_jump);
+}
+
+void Compiler::visit_print_stmt(Print& stmt) {
+    compile(stmt.expression);
+    emit(opcode::PRINT);
+}
+
+void Compiler::visit_return_stmt(Return& stmt) {
+    // The callee replaces the frame of the function and returns in its place
+    if(stmt.tail) {
+        compile_call(static_cast<Call&>(*stmt.value), opcode::TAIL_CALL);
+        return;
+    }
+
+    if(stmt.value != nullptr) compile(stmt.value);
+    else emit(opcode::NIL);
+
+    emit(opcode::RETURN, &stmt.keyword);
+}
+
+void Compiler::visit_variable_stmt(Var& stmt) {
+    if(stmt.initializer != nullptr) compile(stmt.initializer);
+    else emit(opcode::NIL);
+
+    if(states.back().scope_depth == 0)
+        emit_short(opcode::DEFINE_GLOBAL, global_slot(stmt.name), &stmt.name);
+    else
+        add_local(stmt.name);
+}
+
+void Compiler::visit_while_stmt(While& stmt) {
+    auto loop_start = chunk().code.size();
+    compile(stmt.condition);
+
+    auto exit_jump = emit_jump(opcode::JUMP_IF_FALSE);
+    emit(opcode::POP);
+    compile(stmt.body);
+    emit_loop(loop_start);
+
+    patch_jump(exit_jump);
+    emit(opcode::POP);
+}
+
+Value Compiler::visit_assign_expr(Assign& expr) {
+    compile(expr.value);
+    emit_set(expr.name, expr.resolved);
+
+    return {};
+}
+
+Value Compiler::visit_binary_expr(Binary& expr) {
+    compile(expr.left);
+    compile(expr.right);
+
+    opcode op;
+    switch(expr.op.type) {
+        case token_type::BANG_EQUAL: op = opcode::NOT_EQUAL; break;
+        case token_type::EQUAL_EQUAL: op = opcode::EQUAL; break;
+        case token_type::GREATER: op = opcode::GREATER; break;
+        case token_type::GREATER_EQUAL: op = opcode::GREATER_EQUAL; break;
+        case token_type::LESS: op = opcode::LESS; break;
+        case token_type::LESS_EQUAL: op = opcode::LESS_EQUAL; break;
+        case token_type::PLUS: op = opcode::ADD; break;
+        case token_type::MINUS: op = opcode::SUBTRACT; break;
+        case token_type::STAR: op = opcode::MULTIPLY; break;
+        case token_type::SLASH: op = opcode::DIVIDE; break;
+        case token_type::MODULO: op = opcode::MODULO; break;
+        case token_type::BIT_AND: op = opcode::BIT_AND; break;
+        case token_type::BIT_OR: op = opcode::BIT_OR; break;
+        case token_type::XOR: op = opcode::XOR; break;
+        case token_type::LEFT_SHIFT: op = opcode::LEFT_SHIFT; break;
+        case token_type::RIGHT_SHIFT: op = opcode::RIGHT_SHIFT; break;
+        default:
+            last_token = &expr.op;
+            error("Unknown binary operator.");
+            return {};
+    }
+    emit(op, &expr.op);
+
+    return {};
+}
+
+Value Compiler::visit_call_expr(Call& expr) {
+    compile_call(expr, opcode::CALL);
+
+    return {};
+}
+
+auto Compiler::compile_call(Call& expr, opcode op) -> void {
+    compile(expr.callee);
+    for(const auto& argument : expr.arguments)
+        compile(argument);
+
+    emit(op, static_cast<uint8_t>(expr.arguments.size()), &expr.paren);
+}
+
+Value Compiler::visit_grouping_expr(Grouping& expr) {
+    compile(expr.expr);
+
+    return {};
+}
+
+Value Compiler::visit_literal_expr(Literal& expr) {
+    const auto& value = expr.value;
+
+    if(value.is_nil()) emit(opcode::NIL);
+    else if(value.is_bool()) emit(value.as_bool() ? opcode::TRUE : opcode::FALSE);
+    else emit_constant(value);
+
+    return {};
+}
+
+Value Compiler::visit_logical_expr(Logical& expr) {
+    compile(expr.left);
+
+    if(expr.op.type == token_type::OR) {
+        auto else_jump = emit_jump(opcode::JUMP_IF_FALSE);
+        auto end_jump = emit_jump(opcode::JUMP);
+        patch_jump(else_jump);
+        emit(opcode::POP);
+        compile(expr.right);
+        patch_jump(end_jump);
+    } else {
+        auto end_jump = emit_jump(opcode::JUMP_IF_FALSE);
+        emit(opcode::POP);
+        compile(expr.right);
+        patch_jump(end_jump);
+    }
+
+    return {};
+}
+
+Value Compiler::visit_unary_expr(Unary& expr) {
+    compile(expr.right);
+
+    switch(expr.op.type) {
+        case token_type::BANG: emit(opcode::NOT, &expr.op); break;
+        case token_type::MINUS: emit(opcode::NEGATE, &expr.op); break;
+        case token_type::NOT: emit(opcode::BIT_NOT, &expr.op); break;
+        default:
+            last_token = &expr.op;
+            error("Unknown unary operator.");
+    }
+
+    return {};
+}
+
+Value Compiler::visit_variable_expr(Variable& expr) {
+    emit_get(expr.name, expr.resolved);
+
+    return {};
+}
@@ -0,0 +1,96 @@
+/*
+ * Mint interpreter
+ * Developed by Marco Cetica (c) 2022
+ * Released under GPLv3
+ *
+ */
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Stmt.h"
+#include "Chunk.h"
+
+class VM;
+
+/*
+ * Compiles a resolved program into bytecode for the VM. Variables the
+ * resolver left unresolved become global slots, every other variable
+ * lives in a stack slot of its function, or in an upvalue when it is
+ * captured by a nested function.
+ */
+class Compiler : public ExprVisitor, public StmtVisitor {
+public:
+    explicit Compiler(VM& vm) : vm(vm) {};
+    auto compile(const std::vector<Stmt*>& statements) -> Value;
+    // Stmt abstract class
+    void visit_block_stmt(Block& stmt) override;
+    void visit_expression_stmt(Expression& stmt) override;
+    void visit_function_stmt(Function& stmt) override;
+    void visit_if_stmt(If& stmt) override;
+    void visit_print_stmt(Print& stmt) override;
+    void visit_return_stmt(Return& stmt) override;
+    void visit_variable_stmt(Var& stmt) override;
+    void visit_while_stmt(While& stmt) override;
+    // Expr abstract class
+    Value visit_assign_expr(Assign& expr) override;
+    Value visit_binary_expr(Binary& expr) override;
+    Value visit_call_expr(Call& expr) override;
+    Value visit_grouping_expr(Grouping& expr) override;
+    Value visit_literal_expr(Literal& expr) override;
+    Value visit_logical_expr(Logical& expr) override;
+    Value visit_unary_expr(Unary& expr) override;
+    Value visit_variable_expr(Variable& expr) override;
+
+private:
+    struct Local {
+        Symbol name;
+        int depth;
+        bool captured;
+    };
+    struct Upvalue {
+        uint8_t index;
+        bool is_local;
+    };
+    struct FunctionState {
+        MintPrototype* function;
+        std::vector<Local> locals;
+        std::vector<Upvalue> upvalues;
+        int scope_depth;
+        // Slots in use after the last instruction, and at the start of
+        // every jump not yet patched(by operand offset)
+        int stack_depth;
+        std::unordered_map<size_t, int> jump_depths;
+    };
+
+    auto compile(Stmt* stmt) -> void;
+    auto compile(Expr* expr) -> void;
+    auto compile_function(Function* function) -> void;
+    auto compile_call(Call& expr, opcode op) -> void;
+    auto chunk() -> Chunk&;
+    auto emit(opcode op, const Token* token = nullptr) -> void;
+    auto emit(opcode op, uint8_t operand, const Token* token = nullptr) -> void;
+    // Tracks the stack depth of the current function and its maximum
+    auto grow_stack(int count) -> void;
+    auto emit_short(opcode op, uint16_t operand, const Token* token = nullptr) -> void;
+    auto emit_jump(opcode op) -> size_t;
+    auto patch_jump(size_t offset) -> void;
+    auto emit_loop(size_t loop_start) -> void;
+    auto emit_constant(Value value) -> void;
+    auto begin_scope() -> void;
+    auto end_scope() -> void;
+    auto error(const std::string& msg) -> void;
+    auto add_local(const Token& name) -> void;
+    auto global_slot(const Token& name) -> uint16_t;
+    auto resolve_local(size_t state, Symbol name) -> int;
+    auto resolve_upvalue(size_t state, Symbol name) -> int;
+    auto add_upvalue(size_t state, uint8_t index, bool is_local, Symbol name) -> int;
+    auto emit_get(const Token& name, const Resolution& resolved) -> void;
+    auto emit_set(const Token& name, const Resolution& resolved) -> void;
+
+    VM& vm;
+    std::vector<FunctionState> states;
+    // Last token an instruction was emitted for, used to report compile errors
+    const Token* last_token = nullptr;
+    bool had_error = false;
+};
@@ -0,0 +1,59 @@
+#include "CountedLoop.h"
+
+namespace {
+    // Whether evaluating 'expr' can assign a variable(directly or through a call)
+    auto has_effects(const Expr* expr) -> bool {
+        if(auto binary = dynamic_cast<const Binary*>(expr))
+            return has_effects(binary->left) || has_effects(binary->right);
+        if(auto logical = dynamic_cast<const Logical*>(expr))
+            return has_effects(logical->left) || has_effects(logical->right);
+        if(auto grouping = dynamic_cast<const Grouping*>(expr)) return has_effects(grouping->expr);
+        if(auto unary = dynamic_cast<const Unary*>(expr)) return has_effects(unary->right);
+
+        return dynamic_cast<const Literal*>(expr) == nullptr && dynamic_cast<const Variable*>(expr) == nullptr;
+    }
+}
+
+auto CountedLoop::match(While& loop) -> std::optional<CountedLoop> {
+    auto condition = dynamic_cast<Binary*>(loop.condition);
+    if(condition == nullptr) return std::nullopt;
+    switch(condition->op.type) {
+        case token_type::LESS: case token_type::LESS_EQUAL:
+        case token_type::GREATER: case token_type::GREATER_EQUAL:
+        case token_type::BANG_EQUAL: break;
+        default: return std::nullopt;
+    }
+    auto counter = dynamic_cast<Variable*>(condition->left);
+    if(counter == nullptr || counter->resolved.is_global() || has_effects(condition->right)) return std::nullopt;
+
+    auto block = dynamic_cast<Block*>(loop.body);
+    if(block == nullptr || block->scoped || block->statements.empty()) return std::nullopt;
+
+    // The increment must be 'i = i + step' or 'i = i - step'
+    auto increment = dynamic_cast<Expression*>(block->statements.back());
+    auto assign = increment != nullptr ? dynamic_cast<Assign*>(increment->expression) : nullptr;
+    auto sum = assign != nullptr ? dynamic_cast<Binary*>(assign->value) : nullptr;
+    if(sum == nullptr || (sum->op.type != token_type::PLUS && sum->op.type != token_type::MINUS))
+        return std::nullopt;
+    auto operand = dynamic_cast<Variable*>(sum->left);
+    auto step = dynamic_cast<Literal*>(sum->right);
+    if(operand == nullptr || step == nullptr || !step->value.is_numeric()) return std::nullopt;
+
+    auto is_counter = [&counter](const Resolution& resolved) {
+        return resolved.depth == counter->resolved.depth && resolved.frame == counter->resolved.frame &&
+               resolved.slot == counter->resolved.slot;
+    };
+    if(!is_counter(assign->resolved) || !is_counter(operand->resolved)) return std::nullopt;
+
+    auto delta = step->value;
+    if(sum->op.type == token_type::MINUS) {
+        if(delta.is_integer() && delta.as_integer() == INT64_MIN) return std::nullopt;
+        delta = delta.is_integer() ? Value(-delta.as_integer()) : Value(-delta.as_number());
+    }
+
+    return CountedLoop{
+        condition, counter->resolved, condition->right,
+        std::vector<Stmt*>(block->statements.begin(), block->statements.end() - 1),
+        increment, delta
+    };
+}
@@ -0,0 +1,80 @@
+/*
+ * Mint interpreter
+ * Developed by Marco Cetica (c) 2022
+ * Released under GPLv3
+ *
+ */
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+#include <vector>
+#include "Stmt.h"
+#include "Operators.h"
+
+/*
+ * A for-loop counting with a local variable, as lowered by the parser:
+ *
+ *   { let i = start; while(i < limit) { body; i = i + step; } }
+ *
+ * The block around the body must declare nothing(so that the resolver
+ * runs it in the scope of the condition) and the limit must neither call
+ * nor assign anything(so that evaluating it leaves the counter alone).
+ * Engines keep the counter in a native integer or double, depending on the
+ * kind of its start value and step, and compare it with the limit directly.
+ * Whenever the counter slot no longer holds the value the loop wrote(i.e.,
+ * the body assigned it) or an integer counter would overflow, engines go
+ * back to running the loop as a plain while statement.
+ */
+struct CountedLoop {
+    // Returns nothing unless 'loop' has the shape above
+    static auto match(While& loop) -> std::optional<CountedLoop>;
+    // Result of the loop condition for any limit
+    template<class T>
+    [[nodiscard]] auto test(T counter, const Value& limit) const -> bool {
+        if constexpr(std::is_same_v<T, int64_t>) {
+            if(limit.is_integer()) return compare(counter, limit.as_integer());
+            if(limit.is_number()) return compare(Operators::compare(counter, limit.as_number()), 0.0);
+        } else if(limit.is_number()) {
+            return compare(counter, limit.as_number());
+        }
+
+        return Operators::is_truthy(Operators::binary(condition->op, counter, limit));
+    }
+    // Whether the counter slot still holds the value the loop wrote
+    template<class T>
+    static auto holds(const Value& slot, T counter) -> bool {
+        if constexpr(std::is_same_v<T, int64_t>) return slot.is_integer() && slot.as_integer() == counter;
+        else return slot.is_number() && slot.as_number() == counter;
+    }
+    // Advances the counter, returns false if it overflows
+    static auto advance(double& counter, double step) -> bool {
+        counter += step;
+        return true;
+    }
+    static auto advance(int64_t& counter, int64_t step) -> bool {
+        return !__builtin_add_overflow(counter, step, &counter);
+    }
+
+    // The loop condition, its counter(left operand) and its limit(right operand)
+    Binary* condition;
+    Resolution counter;
+    Expr* limit;
+    // Statements executed before the increment
+    std::vector<Stmt*> body;
+    Stmt* increment;
+    // An integer or a double literal
+    Value step;
+
+private:
+    template<class T>
+    [[nodiscard]] auto compare(T counter, T limit) const -> bool {
+        switch(condition->op.type) {
+            case token_type::LESS: return counter < limit;
+            case token_type::LESS_EQUAL: return counter <= limit;
+            case token_type::GREATER: return counter > limit;
+            case token_type::GREATER_EQUAL: return counter >= limit;
+            default: return counter != limit;
+        }
+    }
+};
@@ -7,17 +7,17 @@
 #include "Environment.h"
 #include "RuntimeError.h"
 
-auto Environment::get(const Token &name) -> std::any {
-    auto element = values.find(name.lexeme);
+auto Environment::get(const Token &name) -> Value {
+    auto element = values.find(name.symbol);
     if(element != values.end()) return element->second;
 
     if(enclosing != nullptr) return enclosing->get(name);
 
-    throw RuntimeError(name, std::string("Undefined variable '" + name.lexeme + "'"));
+    throw RuntimeError(name, "Undefined variable '" + std::string(name.lexeme) + "'");
 }
 
-auto Environment::assign(const Token &name, std::any value) -> void {
-    auto element = values.find(name.lexeme);
+auto Environment::assign(const Token &name, Value value) -> void {
+    auto element = values.find(name.symbol);
     if(element != values.end()) {
         element->second = std::move(value);
         return;
@@ -28,26 +28,42 @@ auto Environment::assign(const Token &name, std::any value) -> void {
         return;
     }
 
-    throw RuntimeError(name, std::string("Undefined variable '" + name.lexeme + "'"));
+    throw RuntimeError(name, "Undefined variable '" + std::string(name.lexeme) + "'");
 }
 
-auto Environment::define(const std::string &name, std::any value) -> void {
+auto Environment::define(Symbol name, Value value) -> void {
     values[name] = std::move(value);
 }
 
-auto Environment::ancestor(const unsigned int distance) -> std::shared_ptr<Environment> {
-    auto env = shared_from_this();
+auto Environment::cell(Symbol name) -> Value* {
+    auto element = values.find(name);
 
-    for(size_t i = 0; i < distance; i++)
-        env = env->enclosing;
+    return element != values.end() ? &element->second : nullptr;
+}
+
+auto Environment::define(Value value) -> void {
+    slots.push_back(std::move(value));
+}
+
+auto Environment::references() const -> long {
+    return weak_from_this().use_count();
+}
 
-    return env;
+auto Environment::traverse(const Visitor& visit) -> void {
+    if(enclosing != nullptr) visit(enclosing.get());
+    for(const auto& [name, value] : values)
+        Collector::visit(value, visit);
+    for(const auto& value : slots)
+        Collector::visit(value, visit);
 }
 
-auto Environment::get_at(const unsigned int distance, const std::string& name) -> std::any {
-    return ancestor(distance)->values[name];
+auto Environment::pin() -> std::shared_ptr<void> {
+    return shared_from_this();
 }
 
-auto Environment::assign_at(unsigned int distance, const Token& name, std::any value) -> void {
-    ancestor(distance)->values[name.lexeme] = std::move(value);
+auto Environment::clear() -> void {
+    enclosing.reset();
+    values.clear();
+    slots.clear();
+    generation = next_generation++;
 }
@@ -5,24 +5,58 @@
  *
  */
 #pragma once
+#include <cstdint>
 #include <memory>
-#include <any>
-#include <map>
+#include <unordered_map>
+#include <vector>
 #include "Token.h"
+#include "Value.h"
+#include "Collector.h"
 
-class Environment : public std::enable_shared_from_this<Environment> {
+/*
+ * The global environment stores its variables by(interned) name, since
+ * globals are not resolved statically. Every other environment is
+ * a flat array of slots: the resolver assigns each local declaration
+ * the index it will occupy, so locals are read by (distance, slot).
+ */
+class Environment : public Collectable, public std::enable_shared_from_this<Environment> {
 friend class Interpreter;
 public:
-    Environment() : enclosing(nullptr) {};
-    explicit Environment(std::shared_ptr<Environment> enclosing) : enclosing(std::move(enclosing)) {};
-    auto get(const Token& name) -> std::any;
-    auto assign(const Token& name, std::any value) -> void;
-    auto define(const std::string& name, std::any value) -> void;
-    auto assign_at(unsigned int distance, const Token& name, std::any value) -> void;
-    auto ancestor(unsigned int distance) -> std::shared_ptr<Environment>;
-    auto get_at(unsigned int distance, const std::string& name) -> std::any;
+    Environment() : enclosing(nullptr), generation(next_generation++) {};
+    explicit Environment(std::shared_ptr<Environment> enclosing)
+        : enclosing(std::move(enclosing)), generation(next_generation++) {};
+    auto get(const Token& name) -> Value;
+    auto assign(const Token& name, Value value) -> void;
+    auto define(Symbol name, Value value) -> void;
+    auto define(Value value) -> void;
+    // Storage of a named variable, stable until the environment is cleared
+    auto cell(Symbol name) -> Value*;
+    // Identifies the named variables currently stored. Unique across
+    // environments, and renewed when they are dropped
+    [[nodiscard]] auto current_generation() const -> uint64_t { return generation; }
+    auto ancestor(unsigned int distance) -> Environment* {
+        auto env = this;
+        for(auto i = 0U; i < distance; i++)
+            env = env->enclosing.get();
+
+        return env;
+    }
+    auto get_at(unsigned int distance, unsigned int slot) -> const Value& {
+        return ancestor(distance)->slots[slot];
+    }
+    auto assign_at(unsigned int distance, unsigned int slot, Value value) -> void {
+        ancestor(distance)->slots[slot] = std::move(value);
+    }
+    [[nodiscard]] auto references() const -> long override;
+    auto traverse(const Visitor& visit) -> void override;
+    auto pin() -> std::shared_ptr<void> override;
+    auto clear() -> void override;
 private:
     std::shared_ptr<Environment> enclosing;
-    std::map<std::string, std::any> values;
+    std::unordered_map<Symbol, Value> values;
+    std::vector<Value> slots;
+    uint64_t generation;
+
+    static inline uint64_t next_generation = 1;
 };
 
@@ -5,11 +5,11 @@
  *
  */
 #pragma once
-#include <any>
-#include <memory>
+#include <cstdint>
 #include <utility>
 #include <vector>
 #include "Token.h"
+#include "Value.h"
 
 struct Binary;
 struct Call;
@@ -19,114 +19,137 @@ struct Logical;
 struct Unary;
 struct Variable;
 struct Assign;
+struct Var;
 
 class ExprVisitor {
 public:
-    [[nodiscard]] virtual std::any visit_binary_expr(std::shared_ptr<Binary> expr) = 0;
-    [[nodiscard]] virtual std::any visit_call_expr(std::shared_ptr<Call> expr) = 0;
-    [[nodiscard]] virtual std::any visit_grouping_expr(std::shared_ptr<Grouping> expr) = 0;
-    [[nodiscard]] virtual std::any visit_literal_expr(std::shared_ptr<Literal> expr) = 0;
-    [[nodiscard]] virtual std::any visit_logical_expr(std::shared_ptr<Logical> expr) = 0;
-    [[nodiscard]] virtual std::any visit_unary_expr(std::shared_ptr<Unary> expr) = 0;
-    [[nodiscard]] virtual std::any visit_variable_expr(std::shared_ptr<Variable> expr) = 0;
-    [[nodiscard]] virtual std::any visit_assign_expr(std::shared_ptr<Assign> expr) = 0;
+    [[nodiscard]] virtual Value visit_binary_expr(Binary& expr) = 0;
+    [[nodiscard]] virtual Value visit_call_expr(Call& expr) = 0;
+    [[nodiscard]] virtual Value visit_grouping_expr(Grouping& expr) = 0;
+    [[nodiscard]] virtual Value visit_literal_expr(Literal& expr) = 0;
+    [[nodiscard]] virtual Value visit_logical_expr(Logical& expr) = 0;
+    [[nodiscard]] virtual Value visit_unary_expr(Unary& expr) = 0;
+    [[nodiscard]] virtual Value visit_variable_expr(Variable& expr) = 0;
+    [[nodiscard]] virtual Value visit_assign_expr(Assign& expr) = 0;
     virtual ~ExprVisitor() = default;
 };
 
+/*
+ * Where a variable lives, as computed by the resolver.
+ * Unresolved variables are looked up in the global environment.
+ */
+struct Resolution {
+    [[nodiscard]] auto is_global() const -> bool { return depth < 0; }
+
+    int depth = -1;
+    unsigned int slot = 0;
+    // Locals of framed functions are stored in the stack frame of the call,
+    // at 'slot'
+    bool frame = false;
+    // Declaration of local variables introduced by 'let'
+    Var* declaration = nullptr;
+    // Inline cache of global variables: the storage cell found by the last
+    // lookup, valid while the global environment keeps the same generation
+    Value* cell = nullptr;
+    uint64_t generation = 0;
+};
+
 class Expr {
 public:
-    virtual std::any accept(ExprVisitor& visitor) = 0;
+    virtual Value accept(ExprVisitor& visitor) = 0;
     virtual ~Expr() = default;
 };
 
-struct Binary : Expr, public std::enable_shared_from_this<Binary> {
-    Binary(std::shared_ptr<Expr> left, Token op, std::shared_ptr<Expr> right)
-        : left(std::move(left)), op(std::move(op)), right(std::move(right)) {};
+struct Binary : Expr {
+    Binary(Expr* left, Token op, Expr* right)
+        : left(left), op(std::move(op)), right(right) {};
 
-    std::any accept(ExprVisitor& visitor) override {
-        return visitor.visit_binary_expr(shared_from_this());
+    Value accept(ExprVisitor& visitor) override {
+        return visitor.visit_binary_expr(*this);
     }
 
-    const std::shared_ptr<Expr> left;
+    Expr* const left;
     const Token op;
-    const std::shared_ptr<Expr> right;
+    Expr* const right;
 };
 
-struct Grouping : Expr, public std::enable_shared_from_this<Grouping> {
-    explicit Grouping(std::shared_ptr<Expr> expr)
-        : expr(std::move(expr)) {};
+struct Grouping : Expr {
+    explicit Grouping(Expr* expr)
+        : expr(expr) {};
 
-    std::any accept(ExprVisitor& visitor) override {
-        return visitor.visit_grouping_expr(shared_from_this());
+    Value accept(ExprVisitor& visitor) override {
+        return visitor.visit_grouping_expr(*this);
     }
 
-    const std::shared_ptr<Expr> expr;
+    Expr* const expr;
 };
 
-struct Literal : Expr, public std::enable_shared_from_this<Literal> {
-    explicit Literal(std::any value) : value(std::move(value)) {};
-    std::any accept(ExprVisitor& visitor) override {
-        return visitor.visit_literal_expr(shared_from_this());
+struct Literal : Expr {
+    explicit Literal(Value value) : value(std::move(value)) {};
+    Value accept(ExprVisitor& visitor) override {
+        return visitor.visit_literal_expr(*this);
     }
 
-    const std::any value;
+    const Value value;
 };
 
-struct Logical : Expr, public std::enable_shared_from_this<Logical> {
-    Logical(std::shared_ptr<Expr> left, Token op, std::shared_ptr<Expr> right)
-        : left(std::move(left)), op(std::move(op)), right(std::move(right)) {};
+struct Logical : Expr {
+    Logical(Expr* left, Token op, Expr* right)
+        : left(left), op(std::move(op)), right(right) {};
 
-    std::any accept(ExprVisitor& visitor) override {
-        return visitor.visit_logical_expr(shared_from_this());
+    Value accept(ExprVisitor& visitor) override {
+        return visitor.visit_logical_expr(*this);
     }
 
-    const std::shared_ptr<Expr> left;
+    Expr* const left;
     const Token op;
-    const std::shared_ptr<Expr> right;
+    Expr* const right;
 };
 
-struct Unary : Expr, public std::enable_shared_from_this<Unary> {
-    Unary(Token op, std::shared_ptr<Expr> right) : op(std::move(op)), right(std::move(right)) {};
-    std::any accept(ExprVisitor& visitor) override {
-        return visitor.visit_unary_expr(shared_from_this());
+struct Unary : Expr {
+    Unary(Token op, Expr* right) : op(std::move(op)), right(right) {};
+    Value accept(ExprVisitor& visitor) override {
+        return visitor.visit_unary_expr(*this);
     }
 
     const Token op;
-    const std::shared_ptr<Expr> right;
+    Expr* const right;
 };
 
-struct Variable : Expr, public std::enable_shared_from_this<Variable> {
+struct Variable : Expr {
     explicit Variable(Token name) : name(std::move(name)) {};
 
-    std::any accept(ExprVisitor& visitor) override {
-        return visitor.visit_variable_expr(shared_from_this());
+    Value accept(ExprVisitor& visitor) override {
+        return visitor.visit_variable_expr(*this);
     }
 
     const Token name;
+    Resolution resolved;
 };
 
-struct Assign : Expr, public std::enable_shared_from_this<Assign> {
-    Assign(Token name, std::shared_ptr<Expr> value)
-        : name(std::move(name)), value(std::move(value)) {};
+struct Assign : Expr {
+    Assign(Token name, Expr* value)
+        : name(std::move(name)), value(value) {};
 
-    std::any accept(ExprVisitor& visitor) override {
-        return visitor.visit_assign_expr(shared_from_this());
+    Value accept(ExprVisitor& visitor) override {
+        return visitor.visit_assign_expr(*this);
     }
 
     const Token name;
-    const std::shared_ptr<Expr> value;
+    Expr* const value;
+    Resolution resolved;
 };
 
-struct Call : Expr, public std::enable_shared_from_this<Call> {
-    Call(std::shared_ptr<Expr>  callee, Token  paren, std::vector<std::shared_ptr<Expr>>  arguments)
-        : callee(std::move(callee)), paren(std::move(paren)), arguments(std::move(arguments)) {};
+struct Call : Expr {
+    Call(Expr* callee, Token paren, std::vector<Expr*> arguments)
+        : callee(callee), paren(std::move(paren)), arguments(std::move(arguments)) {};
 
-    std::any accept(ExprVisitor& visitor) override {
-        return visitor.visit_call_expr(shared_from_this());
+    Value accept(ExprVisitor& visitor) override {
+        return visitor.visit_call_expr(*this);
     }
 
-    const std::shared_ptr<Expr> callee;
+    Expr* const callee;
     const Token paren;
-    const std::vector<std::shared_ptr<Expr>> arguments;
+    const std::vector<Expr*> arguments;
 };
 
@@ -0,0 +1,33 @@
+#include <mutex>
+#include <unordered_map>
+#include "Interner.h"
+
+// Keys point to the characters of the interned strings
+static auto table() -> std::unordered_map<std::string_view, Value>& {
+    static std::unordered_map<std::string_view, Value> strings;
+    return strings;
+}
+
+// Reference counts are not atomic: the table holds the only reference
+// it takes, so looking up a symbol from several threads never touches them
+static auto lookup(std::string_view chars) -> Symbol {
+    static std::mutex lock;
+    std::lock_guard<std::mutex> guard(lock);
+    auto& strings = table();
+    auto elem = strings.find(chars);
+    if(elem != strings.end()) return elem->second.as_object<MintString>();
+
+    auto str = new MintString(std::string(chars));
+    str->interned = true;
+    strings.emplace(str->chars(), Value(str));
+
+    return str;
+}
+
+auto Interner::intern(std::string_view chars) -> Value {
+    return Value(const_cast<MintString*>(lookup(chars)));
+}
+
+auto Interner::symbol(std::string_view chars) -> Symbol {
+    return lookup(chars);
+}
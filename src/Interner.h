@@ -0,0 +1,25 @@
+/*
+ * Mint interpreter
+ * Developed by Marco Cetica (c) 2022
+ * Released under GPLv3
+ *
+ */
+#pragma once
+#include <string_view>
+#include "Value.h"
+
+// An interned string, unique for its contents
+using Symbol = const MintString*;
+
+/*
+ * Global table of interned strings. Identifiers and string literals
+ * are interned, so equal names share the same MintString and can be
+ * compared(and hashed) by address. Interned strings are never freed.
+ * symbol() can be called from several threads(i.e., by the lexers of a
+ * parallel scan), intern() only from the interpreter thread.
+ */
+class Interner {
+public:
+    static auto intern(std::string_view chars) -> Value;
+    static auto symbol(std::string_view chars) -> Symbol;
+};
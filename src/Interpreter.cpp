@@ -1,329 +1,294 @@
-#include <iostream>
+#include <array>
 #include <utility>
-#include <cmath>
 #include "Interpreter.h"
 #include "RuntimeError.h"
 #include "Mint.h"
 #include "Environment.h"
 #include "MintFunction.h"
+#include "Natives.h"
+#include "Operators.h"
+#include "Output.h"
 
 #define UNUSED(x) (void)(x)
 
-Interpreter::Interpreter() = default;
+Interpreter::Interpreter() {
+    for(const auto& native : Natives::registry())
+        globals->define(Interner::symbol(native.as_object<MintNative>()->name), native);
+}
 
-auto Interpreter::interpret(const std::vector<std::shared_ptr<Stmt>>& statements) -> void {
+auto Interpreter::interpret(const std::vector<Stmt*>& statements) -> void {
     try {
         for(const auto &statement : statements)
             execute(statement);
     } catch(const RuntimeError& err) {
+        // Drop the frames of the calls the error unwound
+        stack.clear();
+        frame = 0;
+        tail_callee = nullptr;
         Mint::runtime_error(err);
     }
 }
 
-auto Interpreter::resolve(const std::shared_ptr<Expr>& expr, const int depth) -> void {
-    locals[expr] = depth;
+auto Interpreter::define(const Token& name, Value value) -> void {
+    // Locals are appended in declaration order, which matches the
+    // slot the resolver assigned to them
+    if(environment == globals) globals->define(name.symbol, std::move(value));
+    else environment->define(std::move(value));
+}
+
+auto Interpreter::global_cell(Resolution& resolved, const Token& name) -> Value* {
+    // Map nodes never move, so a cell stays valid as long as the
+    // environment does not drop its variables
+    if(resolved.generation != globals->current_generation()) {
+        resolved.cell = globals->cell(name.symbol);
+        if(resolved.cell == nullptr) return nullptr;
+        resolved.generation = globals->current_generation();
+    }
+
+    return resolved.cell;
+}
+
+auto Interpreter::local(const Resolution& resolved) -> Value& {
+    if(resolved.frame) return stack[frame + resolved.slot];
+
+    return environment->ancestor(resolved.depth)->slots[resolved.slot];
 }
 
-auto Interpreter::execute_block(const std::vector<std::shared_ptr<Stmt>>& statements,
-                                std::shared_ptr<Environment> env) -> void {
+auto Interpreter::execute_block(const std::vector<Stmt*>& statements,
+                                std::shared_ptr<Environment> env) -> completion {
     auto previous = this->environment;
+    auto result = completion::NORMAL;
     try {
         this->environment = std::move(env);
 
         for(const auto& statement : statements)
-            execute(statement);
+            if((result = execute(statement)) == completion::RETURN) break;
     } catch(...) {
         this->environment = previous;
         throw;
     }
 
     this->environment = previous;
+
+    return result;
 }
 
-auto Interpreter::execute(const std::shared_ptr<Stmt>& stmt) -> void {
+auto Interpreter::execute(Stmt* stmt) -> completion {
     stmt->accept(*this);
-}
 
-auto Interpreter::evaluate(const std::shared_ptr<Expr>& expr) {
-    return expr->accept(*this);
+    // Consume the signal, so it does not leak into the statement
+    // that called the function being executed
+    return std::exchange(signal, completion::NORMAL);
 }
 
-auto Interpreter::lookup_variable(const Token& name, const std::shared_ptr<Expr>& expr) {
-    auto elem = locals.find(expr);
-    if(elem != locals.end()) {
-        auto distance = elem->second;
-        return environment->get_at(distance, name.lexeme);
-    } else return globals->get(name);
+auto Interpreter::evaluate(Expr* expr) {
+    return expr->accept(*this);
 }
 
-std::any Interpreter::visit_binary_expr(std::shared_ptr<Binary> expr)  {
-    auto left = evaluate(expr->left);
-    auto right = evaluate(expr->right);
-
-    switch (expr->op.type) {
-        case token_type::BANG_EQUAL: return !is_equal(left, right);
-        case token_type::EQUAL_EQUAL: return is_equal(left, right);
-        case token_type::GREATER:
-            check_number_operands(expr->op, left, right);
-            return std::any_cast<double>(left) > std::any_cast<double>(right);
-        case token_type::GREATER_EQUAL:
-            check_number_operands(expr->op, left, right);
-            return std::any_cast<double>(left) >= std::any_cast<double>(right);
-        case token_type::LESS:
-            check_number_operands(expr->op, left, right);
-            return std::any_cast<double>(left) < std::any_cast<double>(right);
-        case token_type::LESS_EQUAL:
-            check_number_operands(expr->op, left, right);
-            return std::any_cast<double>(left) <= std::any_cast<double>(right);
-        case token_type::MINUS:
-            check_number_operands(expr->op, left, right);
-            return std::any_cast<double>(left) - std::any_cast<double>(right);
-        case token_type::PLUS:
-            if(left.type() == typeid(double) && right.type() == typeid(double))
-                return std::any_cast<double>(left) + std::any_cast<double>(right);
-            if(left.type() == typeid(std::string) && right.type() == typeid(std::string))
-                return std::any_cast<std::string>(left) + std::any_cast<std::string>(right);
-
-            throw RuntimeError(expr->op, "Operands must be two numbers or two strings.");
-        case token_type::SLASH:
-            check_number_operands(expr->op, left, right);
-            return std::any_cast<double>(left) / std::any_cast<double>(right);
-        case token_type::STAR:
-            check_number_operands(expr->op, left, right);
-            return std::any_cast<double>(left) * std::any_cast<double>(right);
-        case token_type::MODULO: {
-            check_number_operands(expr->op, left, right);
-            auto left_exp = std::any_cast<double>(left);
-            auto right_expr = std::any_cast<double>(right);
-            return std::fmod(left_exp, right_expr);
-        }
-        case token_type::BIT_AND: {
-            check_number_operands(expr->op, left, right);
-            auto left_exp = std::any_cast<double>(left);
-            auto right_expr = std::any_cast<double>(right);
-
-            return ((long)left_exp & (long)right_expr);
-        }
-        case token_type::BIT_OR: {
-            check_number_operands(expr->op, left, right);
-            auto left_expr = std::any_cast<double>(left);
-            auto right_expr = std::any_cast<double>(right);
-
-            return ((long)left_expr | (long)right_expr);
-        }
-        case token_type::XOR: {
-            check_number_operands(expr->op, left, right);
-            auto left_expr = std::any_cast<double>(left);
-            auto right_expr = std::any_cast<double>(right);
-
-            return ((long)left_expr ^ (long)right_expr);
-        }
-        case token_type::LEFT_SHIFT: {
-            check_number_operands(expr->op, left, right);
-            auto left_expr = std::any_cast<double>(left);
-            auto right_expr = std::any_cast<double>(right);
-
-            return ((long)left_expr << (long)right_expr);
-        }
-        case token_type::RIGHT_SHIFT: {
-            check_number_operands(expr->op, left, right);
-            auto left_expr = std::any_cast<double>(left);
-            auto right_expr = std::any_cast<double>(right);
-
-            return ((long)left_expr >> (long)right_expr);
-        }
-        default: break;
-    }
+Value Interpreter::visit_binary_expr(Binary& expr) {
+    auto left = evaluate(expr.left);
+    auto right = evaluate(expr.right);
 
-    return {};
+    return Operators::binary(expr.op, left, right);
 }
 
-std::any Interpreter::visit_grouping_expr(std::shared_ptr<Grouping> expr) {
-    return evaluate(expr->expr);
+Value Interpreter::visit_grouping_expr(Grouping& expr) {
+    return evaluate(expr.expr);
 }
 
-std::any Interpreter::visit_literal_expr(std::shared_ptr<Literal> expr) {
-    return expr->value;
+Value Interpreter::visit_literal_expr(Literal& expr) {
+    return expr.value;
 }
 
-std::any Interpreter::visit_logical_expr(std::shared_ptr<Logical> expr) {
-    auto left = evaluate(expr->left);
+Value Interpreter::visit_logical_expr(Logical& expr) {
+    auto left = evaluate(expr.left);
 
-    if(expr->op.type == token_type::OR) {
-        if (is_truthy(left)) return left;
+    if(expr.op.type == token_type::OR) {
+        if (Operators::is_truthy(left)) return left;
     }
     else {
-        if (!is_truthy(left)) return left;
+        if (!Operators::is_truthy(left)) return left;
     }
 
-    return evaluate(expr->right);
+    return evaluate(expr.right);
 }
 
-std::any Interpreter::visit_unary_expr(std::shared_ptr<Unary> expr) {
-    auto right = evaluate(expr->right);
-
-    switch (expr->op.type) {
-        case token_type::BANG: return !is_truthy(right);
-        case token_type::MINUS:
-            check_number_operand(expr->op, right);
-            return -std::any_cast<double>(right);
-        case token_type::NOT:
-            check_number_operand(expr->op, right);
-            return ~(long)std::any_cast<double>(right);
-        default: break;
-    }
-
-    return {};
-}
+Value Interpreter::visit_unary_expr(Unary& expr) {
+    auto right = evaluate(expr.right);
 
-std::any Interpreter::visit_variable_expr(std::shared_ptr<Variable> expr) {
-    return lookup_variable(expr->name, expr);
+    return Operators::unary(expr.op, right);
 }
 
-std::any Interpreter::visit_assign_expr(std::shared_ptr<Assign> expr) {
-    auto value = evaluate(expr->value);
-    auto elem = locals.find(expr);
+Value Interpreter::visit_variable_expr(Variable& expr) {
+    const auto& resolved = expr.resolved;
+    if(!resolved.is_global())
+        return local(resolved);
 
-    if(elem != locals.end()) {
-        auto distance = elem->second;
-        environment->assign_at(distance, expr->name, value);
-    } else globals->assign(expr->name, value);
+    if(auto cell = global_cell(expr.resolved, expr.name)) return *cell;
 
-    return value;
+    return globals->get(expr.name);
 }
 
-std::any Interpreter::visit_call_expr(std::shared_ptr<Call> expr) {
-    auto callee = evaluate(expr->callee);
-
-    std::vector<std::any> arguments;
-    for(auto &argument : expr->arguments)
-        arguments.push_back(evaluate(argument));
+Value Interpreter::visit_assign_expr(Assign& expr) {
+    auto value = evaluate(expr.value);
+    const auto& resolved = expr.resolved;
 
-    std::shared_ptr<MintCallable> function;
+    if(!resolved.is_global())
+        local(resolved) = value;
+    else if(auto cell = global_cell(expr.resolved, expr.name)) *cell = value;
+    else globals->assign(expr.name, value);
 
-    if(callee.type() == typeid(std::shared_ptr<MintFunction>))
-        function = std::any_cast<std::shared_ptr<MintFunction>>(callee);
-    else
-        throw RuntimeError(expr->paren, "Can only call functions and classes.");
+    return value;
+}
 
-    if(arguments.size() != function->arity()) {
-        throw RuntimeError(expr->paren, "Expected " +
-            std::to_string(function->arity()) + " arguments but got " +
-            std::to_string(arguments.size()) + ".");
+Value Interpreter::visit_call_expr(Call& expr) {
+    auto callee = evaluate(expr.callee);
+    if(callee.is_native()) {
+        auto native = callee.as_object<MintNative>();
+        if(expr.arguments.size() == native->params) return call_native(expr, *native);
     }
+    auto callee_frame = push_arguments(expr, callee);
 
-    return function->call(*this, std::move(arguments));
+    return callee.as_object<MintCallable>()->call(*this, callee_frame);
 }
 
-std::any Interpreter::visit_block_stmt(std::shared_ptr<Block> stmt) {
-    execute_block(stmt->statements, std::make_shared<Environment>(environment));
+auto Interpreter::call_native(Call& expr, const MintNative& native) -> Value {
+    // Arguments go to a local array, the value stack is left alone
+    std::array<Value, MintNative::MAX_ARITY> arguments;
+    for(auto i = 0U; i < native.params; i++)
+        arguments[i] = evaluate(expr.arguments[i]);
 
-    return {};
+    return native.function(arguments.data());
 }
 
-std::any Interpreter::visit_expression_stmt(std::shared_ptr<Expression> stmt) {
-    evaluate(stmt->expression);
+auto Interpreter::push_arguments(Call& expr, const Value& callee) -> size_t {
+    // Arguments are evaluated straight into the frame of the callee
+    auto callee_frame = stack.size();
+    for(auto &argument : expr.arguments)
+        stack.push_back(evaluate(argument));
+
+    if(!callee.is_callable())
+        throw RuntimeError(expr.paren, "Can only call functions and classes.");
+
+    auto function = callee.as_object<MintCallable>();
+
+    if(expr.arguments.size() != function->arity()) {
+        throw RuntimeError(expr.paren, "Expected " +
+            std::to_string(function->arity()) + " arguments but got " +
+            std::to_string(expr.arguments.size()) + ".");
+    }
 
-    return {};
+    return callee_frame;
 }
 
-std::any Interpreter::visit_print_stmt(std::shared_ptr<Print> stmt) {
-    auto value = evaluate(stmt->expression);
-    std::cout << stringify(value) << std::endl;
+auto Interpreter::slide_tail_call(size_t start) -> void {
+    if(tail_frame == start) return;
 
-    return {};
+    std::move(stack.begin() + static_cast<std::ptrdiff_t>(tail_frame), stack.end(),
+              stack.begin() + static_cast<std::ptrdiff_t>(start));
+    stack.resize(start + stack.size() - tail_frame);
+    tail_frame = start;
 }
 
-std::any Interpreter::visit_variable_stmt(std::shared_ptr<Var> stmt) {
-    std::any value = nullptr;
-    if(stmt->initializer != nullptr)
-        value = evaluate(stmt->initializer);
+void Interpreter::visit_block_stmt(Block& stmt) {
+    if(!stmt.scoped) {
+        for(const auto& statement : stmt.statements)
+            if((signal = execute(statement)) == completion::RETURN) return;
 
-    environment->define(stmt->name.lexeme, std::move(value));
+        return;
+    }
 
-    return {};
+    signal = execute_block(stmt.statements, std::make_shared<Environment>(environment));
 }
 
-std::any Interpreter::visit_if_stmt(std::shared_ptr<If> stmt) {
-    if(is_truthy(evaluate(stmt->condition)))
-        execute(stmt->then_branch);
-    else if(stmt->else_branch != nullptr)
-        execute(stmt->else_branch);
+void Interpreter::visit_expression_stmt(Expression& stmt) {
+    evaluate(stmt.expression);
+}
 
-    return {};
+void Interpreter::visit_print_stmt(Print& stmt) {
+    auto value = evaluate(stmt.expression);
+    Output::print(value);
 }
 
-std::any Interpreter::visit_while_stmt(std::shared_ptr<While> stmt) {
-    while(is_truthy(evaluate(stmt->condition)))
-        execute(stmt->body);
+void Interpreter::visit_variable_stmt(Var& stmt) {
+    Value value = nullptr;
+    if(stmt.initializer != nullptr)
+        value = evaluate(stmt.initializer);
 
-    return {};
+    if(stmt.frame_slot) stack[frame + *stmt.frame_slot] = std::move(value);
+    else define(stmt.name, std::move(value));
 }
 
-auto Interpreter::check_number_operand(const Token &op, const std::any &operand) -> void {
-    if(operand.type() == typeid(double)) return;
-    throw RuntimeError(op, "Operand must be a number.");
+void Interpreter::visit_if_stmt(If& stmt) {
+    if(Operators::is_truthy(evaluate(stmt.condition)))
+        signal = execute(stmt.then_branch);
+    else if(stmt.else_branch != nullptr)
+        signal = execute(stmt.else_branch);
 }
 
-auto Interpreter::check_number_operands(const Token &op, const std::any &left, const std::any &right) -> void {
-    if(left.type() == typeid(double) && right.type() == typeid(double)) return;
+void Interpreter::visit_while_stmt(While& stmt) {
+    if(!stmt.matched) {
+        if(auto loop = CountedLoop::match(stmt)) stmt.counted = std::make_shared<const CountedLoop>(std::move(*loop));
+        stmt.matched = true;
+    }
 
-    throw RuntimeError(op, "Operands must be numbers.");
+    signal = stmt.counted != nullptr ? execute_counted_loop(stmt, *stmt.counted) : execute_loop(stmt);
 }
 
-auto Interpreter::is_truthy(const std::any &object) -> bool {
-    if(object.type() == typeid(nullptr)) return false;
-    if(object.type() == typeid(bool))
-        return std::any_cast<bool>(object);
+auto Interpreter::execute_loop(While& stmt) -> completion {
+    while(Operators::is_truthy(evaluate(stmt.condition)))
+        if(execute(stmt.body) == completion::RETURN) return completion::RETURN;
 
-    return true;
+    return completion::NORMAL;
 }
 
-auto Interpreter::is_equal(const std::any &a, const std::any &b) -> bool {
-    if(a.type() == typeid(nullptr) && b.type() == typeid(nullptr)) return true;
-    if(a.type() == typeid(nullptr)) return false;
-    if(a.type() == typeid(std::string) && b.type() == typeid(std::string))
-        return std::any_cast<std::string>(a) == std::any_cast<std::string>(b);
-    if(a.type() == typeid(double) && b.type() == typeid(double))
-        return std::any_cast<double>(a) == std::any_cast<double>(b);
-    if(a.type() == typeid(bool) && b.type() == typeid(bool))
-        return std::any_cast<bool>(a) == std::any_cast<bool>(b);
-
-    return false;
+auto Interpreter::execute_counted_loop(While& stmt, const CountedLoop& loop) -> completion {
+    const auto& start = local(loop.counter);
+    if(start.is_integer() && loop.step.is_integer())
+        return count(stmt, loop, start.as_integer(), loop.step.as_integer());
+    if(start.is_number()) return count(stmt, loop, start.as_number(), loop.step.to_number());
+
+    return execute_loop(stmt);
 }
 
-std::string Interpreter::stringify(const std::any &object) {
-    if(object.type() == typeid(nullptr)) return "nil";
-    if(object.type() == typeid(double)) {
-        auto text = std::to_string(std::any_cast<double>(object));
-        if(text[text.length() - 2] == '.' && text[text.length() - 1] == '0')
-            text = text.substr(0, text.length() - 2);
+template<class T>
+auto Interpreter::count(While& stmt, const CountedLoop& loop, T counter, T step) -> completion {
+    while(true) {
+        if(!loop.test(counter, evaluate(loop.limit))) return completion::NORMAL;
 
-        return text;
+        for(const auto& statement : loop.body)
+            if(execute(statement) == completion::RETURN) return completion::RETURN;
+
+        if(!CountedLoop::holds(local(loop.counter), counter) || !CountedLoop::advance(counter, step)) {
+            // The body assigned the counter, or it would overflow: finish
+            // this iteration as written
+            execute(loop.increment);
+            return execute_loop(stmt);
+        }
+
+        local(loop.counter) = counter;
     }
-    if(object.type() == typeid(long))
-        return std::to_string(std::any_cast<long>(object));
-    if(object.type() == typeid(std::string))
-        return std::any_cast<std::string>(object);
-    if(object.type() == typeid(bool))
-        return std::any_cast<bool>(object) ? "true" : "false";
-    if(object.type() == typeid(std::shared_ptr<MintFunction>))
-        return std::any_cast<std::shared_ptr<MintFunction>>(object)->to_string();
-
-    return "Error in 'stringify': object type not supported.";
 }
 
-std::any Interpreter::visit_function_stmt(std::shared_ptr<Function> stmt) {
-    auto function = std::make_shared<MintFunction>(stmt, environment);
-    environment->define(stmt->name.lexeme, function);
-
-    return {};
+void Interpreter::visit_function_stmt(Function& stmt) {
+    auto function = Value(new MintFunction(&stmt, environment));
+    define(stmt.name, std::move(function));
 }
 
-std::any Interpreter::visit_return_stmt(std::shared_ptr<Return> stmt) {
-    std::any value = nullptr;
+void Interpreter::visit_return_stmt(Return& stmt) {
+    if(stmt.tail) {
+        // Only prepare the call: the caller makes it once this function
+        // has left its frame
+        auto& call = static_cast<Call&>(*stmt.value);
+        auto callee = evaluate(call.callee);
+        tail_frame = push_arguments(call, callee);
+        tail_callee = std::move(callee);
+        signal = completion::RETURN;
+        return;
+    }
 
-    if(stmt->value != nullptr) value = evaluate(stmt->value);
+    return_value = nullptr;
+    if(stmt.value != nullptr) return_value = evaluate(stmt.value);
 
-    throw MintReturn{value};
-}
\ No newline at end of file
+    signal = completion::RETURN;
+}
@@ -9,44 +9,70 @@
 #include "Stmt.h"
 #include "Environment.h"
 #include "MintCallable.h"
+#include "CountedLoop.h"
 
+// How a statement completed: normally or by executing a return statement
+enum class completion { NORMAL, RETURN };
+
+class MintNative;
 class Interpreter : public ExprVisitor, public StmtVisitor {
     friend class MintFunction;
+    friend class MintNative;
 public:
     Interpreter();
-    auto interpret(const std::vector<std::shared_ptr<Stmt>>& statements) -> void;
-    auto resolve(const std::shared_ptr<Expr>& expr, int depth) -> void;
+    auto interpret(const std::vector<Stmt*>& statements) -> void;
     // Expr abstract class
-    std::any visit_binary_expr(std::shared_ptr<Binary> expr) override;
-    std::any visit_grouping_expr(std::shared_ptr<Grouping> expr) override;
-    std::any visit_literal_expr(std::shared_ptr<Literal> expr) override;
-    std::any visit_logical_expr(std::shared_ptr<Logical> expr) override;
-    std::any visit_unary_expr(std::shared_ptr<Unary> expr) override;
-    std::any visit_variable_expr(std::shared_ptr<Variable> expr) override;
-    std::any visit_assign_expr(std::shared_ptr<Assign> expr) override;
-    std::any visit_call_expr(std::shared_ptr<Call> expr) override;
+    Value visit_binary_expr(Binary& expr) override;
+    Value visit_grouping_expr(Grouping& expr) override;
+    Value visit_literal_expr(Literal& expr) override;
+    Value visit_logical_expr(Logical& expr) override;
+    Value visit_unary_expr(Unary& expr) override;
+    Value visit_variable_expr(Variable& expr) override;
+    Value visit_assign_expr(Assign& expr) override;
+    Value visit_call_expr(Call& expr) override;
     // Stmt abstract class
-    std::any visit_block_stmt(std::shared_ptr<Block> stmt) override;
-    std::any visit_expression_stmt(std::shared_ptr<Expression> stmt) override;
-    std::any visit_print_stmt(std::shared_ptr<Print> stmt) override;
-    std::any visit_variable_stmt(std::shared_ptr<Var> stmt) override;
-    std::any visit_if_stmt(std::shared_ptr<If> stmt) override;
-    std::any visit_while_stmt(std::shared_ptr<While> stmt) override;
-    std::any visit_function_stmt(std::shared_ptr<Function> stmt) override;
-    std::any visit_return_stmt(std::shared_ptr<Return> stmt) override;
+    void visit_block_stmt(Block& stmt) override;
+    void visit_expression_stmt(Expression& stmt) override;
+    void visit_print_stmt(Print& stmt) override;
+    void visit_variable_stmt(Var& stmt) override;
+    void visit_if_stmt(If& stmt) override;
+    void visit_while_stmt(While& stmt) override;
+    void visit_function_stmt(Function& stmt) override;
+    void visit_return_stmt(Return& stmt) override;
 
     std::shared_ptr<Environment> globals{new Environment};
 private:
-    auto evaluate(const std::shared_ptr<Expr>& expr);
-    auto lookup_variable(const Token& name, const std::shared_ptr<Expr>& expr);
-    auto execute(const std::shared_ptr<Stmt>& stmt) -> void;
-    auto execute_block(const std::vector<std::shared_ptr<Stmt>>& statements, std::shared_ptr<Environment> env) -> void;
-    static auto check_number_operand(const Token& op, const std::any& operand) -> void;
-    static auto check_number_operands(const Token& op, const std::any& left, const std::any& right) -> void;
-    static auto is_truthy(const std::any& object) -> bool;
-    static auto is_equal(const std::any& a, const std::any& b) -> bool;
-    static auto stringify(const std::any& object) -> std::string;
+    auto evaluate(Expr* expr);
+    auto execute(Stmt* stmt) -> completion;
+    auto define(const Token& name, Value value) -> void;
+    auto global_cell(Resolution& resolved, const Token& name) -> Value*;
+    auto local(const Resolution& resolved) -> Value&;
+    auto push_arguments(Call& expr, const Value& callee) -> size_t;
+    auto call_native(Call& expr, const MintNative& native) -> Value;
+    // Drops the frame starting at 'start'. The arguments of a pending tail
+    // call take its place
+    auto leave_frame(size_t start) -> void {
+        if(tail_callee.is_nil()) stack.resize(start);
+        else slide_tail_call(start);
+    }
+    auto slide_tail_call(size_t start) -> void;
+    auto execute_block(const std::vector<Stmt*>& statements, std::shared_ptr<Environment> env) -> completion;
+    auto execute_loop(While& stmt) -> completion;
+    auto execute_counted_loop(While& stmt, const CountedLoop& loop) -> completion;
+    template<class T>
+    auto count(While& stmt, const CountedLoop& loop, T counter, T step) -> completion;
 
     std::shared_ptr<Environment> environment = globals;
-    std::map<std::shared_ptr<Expr>, int> locals;
+    // Completion of the statement being executed, set by the statement visitors
+    completion signal = completion::NORMAL;
+    // Value of the last executed return statement
+    Value return_value;
+    // Arguments and locals of framed functions. The current call addresses
+    // its slots from index 'frame'
+    std::vector<Value> stack;
+    size_t frame = 0;
+    // Call left pending by a return in tail position(nil when there is
+    // none), with the index of its arguments on the stack
+    Value tail_callee;
+    size_t tail_frame = 0;
 };
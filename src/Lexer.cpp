@@ -1,16 +1,129 @@
+#include <algorithm>
+#include <charconv>
+#include <future>
+#include <memory>
+#include <thread>
 #include "Lexer.h"
+#include "Scanner.h"
 #include "Mint.h"
 
 auto Lexer::scan_tokens() -> std::vector<Token> {
+    scan();
+    report_errors();
+    tokens.emplace_back(token_type::MINT_EOF, "", std::monostate{}, line);
+
+    return std::move(tokens);
+}
+
+auto Lexer::scan_tokens_parallel(std::string_view source, unsigned int chunks) -> std::vector<Token> {
+    auto starts = split(source, chunks);
+    if(starts.size() == 1) return Lexer(source).scan_tokens();
+    starts.push_back(source.size());
+
+    // Each chunk starts on the line where the previous one ends: the line
+    // count is passed along as soon as a chunk has counted its newlines
+    auto count = starts.size() - 1;
+    std::vector<std::promise<unsigned int>> last_lines(count);
+    std::vector<std::unique_ptr<Lexer>> lexers(count);
+    std::vector<std::thread> workers;
+    for(auto i = 0UL; i < count; i++) {
+        workers.emplace_back([&, i] {
+            auto chunk = source.substr(starts[i], starts[i + 1] - starts[i]);
+            auto newlines = static_cast<unsigned int>(std::count(chunk.begin(), chunk.end(), '\n'));
+            auto first_line = i == 0 ? 1 : last_lines[i - 1].get_future().get();
+            last_lines[i].set_value(first_line + newlines);
+
+            lexers[i] = std::make_unique<Lexer>(chunk, first_line);
+            lexers[i]->scan();
+        });
+    }
+    for(auto& worker : workers) worker.join();
+
+    std::vector<Token> tokens;
+    auto size = 1UL;
+    for(const auto& lexer : lexers) size += lexer->tokens.size();
+    tokens.reserve(size);
+    for(const auto& lexer : lexers) {
+        for(const auto& token : lexer->tokens) tokens.push_back(token);
+        lexer->report_errors();
+    }
+    tokens.emplace_back(token_type::MINT_EOF, "", std::monostate{}, lexers.back()->line);
+
+    return tokens;
+}
+
+/*
+ * Chunks start at the beginning of a line outside of string literals. Strings
+ * have no escape sequences, so following the quotes and the comments(which
+ * may contain quotes) is enough to know whether a line starts inside a string.
+ */
+auto Lexer::split(std::string_view source, unsigned int chunks) -> std::vector<size_t> {
+    std::vector<size_t> starts{0};
+    if(chunks < 2) return starts;
+
+    auto size = source.size();
+    auto chunk_size = std::max<size_t>(size / chunks, 1);
+    auto find = [&](char c, size_t from) {
+        auto position = source.find(c, from);
+        return position == std::string_view::npos ? size : position;
+    };
+
+    // Every search only moves forward, so the source is read once
+    size_t position = 0;
+    size_t quote = find('"', 0);
+    size_t slash = find('/', 0);
+    size_t newline = find('\n', chunk_size);
+    auto target = chunk_size;
+    while(starts.size() < chunks && position < size) {
+        if(quote < position) quote = find('"', position);
+        if(slash < position) slash = find('/', position);
+        if(newline < std::max(position, target)) newline = find('\n', std::max(position, target));
+        auto next = std::min(quote, slash);
+
+        // A line ending before the next string or comment is a valid boundary
+        if(newline < next) {
+            if(newline + 1 >= size) break;
+            starts.push_back(newline + 1);
+            target = newline + 1 + chunk_size;
+            continue;
+        }
+        if(next == size) break;
+
+        if(next == slash)
+            position = slash + 1 < size && source[slash + 1] == '/' ? find('\n', slash + 2) : slash + 1;
+        else
+            position = find('"', quote + 1) + 1;
+    }
+
+    return starts;
+}
+
+auto Lexer::scan() -> void {
+    // Real code averages more than four characters per token
+    tokens.reserve(source.size() / 4 + 1);
     while(!is_at_end()) {
         start = current;
         scan_token();
     }
+}
 
-    Token token(token_type::MINT_EOF, "", std::string(""), line);
-    tokens.push_back(token);
+auto Lexer::error(const std::string& msg) -> void {
+    errors.emplace_back(line, msg);
+}
 
-    return tokens;
+auto Lexer::report_errors() -> void {
+    for(const auto& [error_line, msg] : errors)
+        Mint::error(error_line, msg);
+}
+
+auto Lexer::symbol(std::string_view name) -> Symbol {
+    auto elem = symbols.find(name);
+    if(elem != symbols.end()) return elem->second;
+
+    auto interned = Interner::symbol(name);
+    symbols.emplace(name, interned);
+
+    return interned;
 }
 
 auto Lexer::is_at_end() -> bool {
@@ -52,60 +165,63 @@ auto Lexer::scan_token() -> void {
         break;
         case '/': {
                 if(match('/'))
-                    while(peek() != '\n' && !is_at_end())
-                        advance();
+                    seek(Scanner::find_newline(at(current), at(source.size())));
                 else add_token(token_type::SLASH);
             }
             break;
         case ' ':
         case '\r':
-        case '\t': break;
-        case '\n': line++; break;
+        case '\t':
+        case '\n': seek(Scanner::skip_blanks(at(start), at(source.size()), line)); break;
         case '"': parse_string(); break;
         default: {
             if(is_digit(c)) parse_number();
             else if(is_alpha(c)) identifier();
-            else Mint::error(line, "Unexpected character.");
+            else error("Unexpected character.");
         }
     }
 }
 
 auto Lexer::advance() -> char {
-    return source.at(current++);
+    return source[current++];
 }
 
 auto Lexer::add_token(token_type type) -> void {
-    add_token(type, std::string(""));
+    add_token(type, std::monostate{});
 }
 
-auto Lexer::add_token(token_type type, const std::any& literal) -> void {
-    auto text = source.substr(start, current - start);
-    Token token(type, text, literal, line);
-    tokens.push_back(token);
+auto Lexer::add_token(token_type type, TokenLiteral literal) -> void {
+    auto lexeme = source.substr(start, current - start);
+    tokens.emplace_back(type, lexeme, literal, line, type == token_type::IDENTIFIER ? symbol(lexeme) : nullptr);
 }
 
 auto Lexer::match(char expected) -> bool {
     if (is_at_end()) return false;
-    if (source.at(current) != expected) return false;
+    if (source[current] != expected) return false;
     current++;
 
     return true;
 }
 
+auto Lexer::at(unsigned int offset) -> const char* {
+    return source.data() + offset;
+}
+
+auto Lexer::seek(const char* position) -> void {
+    current = static_cast<unsigned int>(position - source.data());
+}
+
 auto Lexer::peek() -> char {
     if(is_at_end()) return '\0';
 
-    return source.at(current);
+    return source[current];
 }
 
 auto Lexer::parse_string() -> void {
-    while(peek() != '"' && !is_at_end()) {
-        if(peek() == '\n') line++;
-        advance();
-    }
+    seek(Scanner::find_quote(at(current), at(source.size()), line));
 
     if(is_at_end()) {
-        Mint::error(line, "Unterminated string.");
+        error("Unterminated string.");
         return;
     }
 
@@ -118,14 +234,23 @@ auto Lexer::parse_string() -> void {
 
 
 auto Lexer::parse_number() -> void {
-    while(isdigit(peek())) advance();
+    while(is_digit(peek())) advance();
 
     if(peek() == '.' && is_digit(peek_next())) {
         advance();
         while(is_digit(peek())) advance();
+    } else {
+        // Integral literals are integers, unless they do not fit in 64 bits
+        int64_t integer = 0;
+        if(std::from_chars(at(start), at(current), integer).ec == std::errc()) {
+            add_token(token_type::NUMBER, integer);
+            return;
+        }
     }
 
-    auto number = std::stod(source.substr(start, current - start));
+    // The lexeme is made of digits only, so the conversion cannot fail
+    double number = 0;
+    std::from_chars(at(start), at(current), number);
     add_token(token_type::NUMBER, number);
 }
 
@@ -134,21 +259,46 @@ constexpr auto Lexer::is_digit(const char c) -> bool {
 }
 
 auto Lexer::peek_next() -> char {
-    if(current - 1 >= source.size()) return '\0';
+    if(current + 1 >= source.size()) return '\0';
 
-    return source.at(current + 1);
+    return source[current + 1];
 }
 
 auto Lexer::identifier() -> void {
-    while(is_alphanumeric(peek())) advance();
-    auto text = source.substr(start, current - start);
-    auto found = keywords.find(text);
-    token_type type;
+    seek(Scanner::skip_identifier(at(current), at(source.size())));
+    add_token(keyword(source.substr(start, current - start)));
+}
 
-    if(found != keywords.end()) type = found->second;
-    else type = token_type::IDENTIFIER;
+// Keywords are told apart by their first letters, then compared once
+constexpr auto Lexer::keyword(std::string_view text) -> token_type {
+    auto check = [text](std::string_view word, token_type type) {
+        return text == word ? type : token_type::IDENTIFIER;
+    };
+
+    switch(text[0]) {
+        case 'e': return check("else", token_type::ELSE);
+        case 'f': {
+            if(text.size() < 2) break;
+            switch(text[1]) {
+                case 'a': return check("false", token_type::FALSE);
+                case 'o': return check("for", token_type::FOR);
+                case 'u': return check("function", token_type::FN);
+                default: break;
+            }
+        }
+        break;
+        case 'i': return check("if", token_type::IF);
+        case 'l': return check("let", token_type::LET);
+        case 'n': return check("nil", token_type::NIL);
+        case 'o': return check("or", token_type::OR);
+        case 'p': return check("print", token_type::PRINT);
+        case 'r': return check("return", token_type::RETURN);
+        case 't': return check("true", token_type::TRUE);
+        case 'w': return check("while", token_type::WHILE);
+        default: break;
+    }
 
-    add_token(type);
+    return token_type::IDENTIFIER;
 }
 
 
@@ -156,8 +306,4 @@ constexpr auto Lexer::is_alpha(const char c) -> bool {
     return (c >= 'a' && c <= 'z')
         || (c >= 'A' && c <= 'Z')
         || c == '_';
-}
-
-constexpr auto Lexer::is_alphanumeric(const char c) -> bool {
-    return is_alpha(c) || is_digit(c);
 }
\ No newline at end of file
@@ -6,55 +6,55 @@
  */
 
 #pragma once
+#include <cstddef>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <utility>
 #include <vector>
-#include <map>
 
 #include "Token.h"
 
 class Lexer {
 public:
-    explicit Lexer(std::string source) : source(std::move(source)) {};
+    // The source must outlive the tokens, which point into it
+    explicit Lexer(std::string_view source, unsigned int line = 1) : line(line), source(source) {};
     auto scan_tokens() -> std::vector<Token>;
+    // Scans the source in up to 'chunks' pieces on separate threads. Tokens
+    // and errors are the same as the ones of scan_tokens()
+    static auto scan_tokens_parallel(std::string_view source, unsigned int chunks) -> std::vector<Token>;
 
 private:
+    static auto split(std::string_view source, unsigned int chunks) -> std::vector<size_t>;
+    auto scan() -> void;
+    auto error(const std::string& msg) -> void;
+    auto report_errors() -> void;
+    auto symbol(std::string_view name) -> Symbol;
     auto is_at_end() -> bool;
     auto scan_token() -> void;
     auto advance() -> char;
     auto add_token(token_type type) -> void;
-    auto add_token(token_type type, const std::any& literal) -> void;
+    auto add_token(token_type type, TokenLiteral literal) -> void;
     auto match(char expected) -> bool;
     auto peek() -> char;
+    // Positions in the source, used with the scanning kernels
+    auto at(unsigned int offset) -> const char*;
+    auto seek(const char* position) -> void;
     auto parse_string() -> void;
     auto parse_number() -> void;
     static constexpr auto is_digit(char c) -> bool;
     static constexpr auto is_alpha(char c) -> bool;
-    static constexpr auto is_alphanumeric(char c) -> bool;
     auto peek_next() -> char;
     auto identifier() -> void;
+    static constexpr auto keyword(std::string_view text) -> token_type;
 
     std::vector<Token> tokens;
     unsigned int start = 0;
     unsigned int current = 0;
     unsigned int line = 1;
-    std::string source;
-    const std::map<std::string, token_type> keywords = {
-            {"&&", token_type::AND},
-            {"||", token_type::OR},
-            {"^", token_type::XOR},
-            {"~", token_type::NOT},
-            {"else", token_type::ELSE},
-            {"false", token_type::FALSE},
-            {"for", token_type::FOR},
-            {"function", token_type::FN},
-            {"if", token_type::IF},
-            {"nil", token_type::NIL},
-            {"or", token_type::OR},
-            {"print", token_type::PRINT},
-            {"return", token_type::RETURN},
-            {"true", token_type::TRUE},
-            {"let", token_type::LET},
-            {"while", token_type::WHILE},
-    };
+    const std::string_view source;
+    // Errors are reported once scanning is over, in source order
+    std::vector<std::pair<unsigned int, std::string>> errors;
+    // Identifiers seen so far, to avoid locking the interner for each of them
+    std::unordered_map<std::string_view, Symbol> symbols;
 };
\ No newline at end of file
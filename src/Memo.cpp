@@ -0,0 +1,85 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string_view>
+#include "Memo.h"
+#include "Operators.h"
+
+namespace {
+    auto bits(double number) -> uint64_t {
+        uint64_t bits;
+        std::memcpy(&bits, &number, sizeof(bits));
+
+        return bits;
+    }
+}
+
+size_t Memo::capacity = 0;
+Memo::Stats Memo::statistics;
+
+auto Memo::set_capacity(size_t entries) -> void {
+    capacity = entries;
+}
+
+auto Memo::stats() -> const Stats& {
+    return statistics;
+}
+
+auto Memo::is_cacheable(const Value& value) -> bool {
+    return !value.is_object() || value.is_string();
+}
+
+auto Memo::is_key(const Key& key) -> bool {
+    return std::all_of(key.begin(), key.end(), is_cacheable);
+}
+
+auto Memo::find(const Key& key) -> const Value* {
+    auto entry = index.find(key);
+    if(entry == index.end()) {
+        statistics.misses++;
+        return nullptr;
+    }
+
+    statistics.hits++;
+    entries.splice(entries.begin(), entries, entry->second);
+
+    return &entry->second->second;
+}
+
+auto Memo::insert(Key key, Value result) -> void {
+    if(!is_cacheable(result) || index.find(key) != index.end()) return;
+
+    if(entries.size() >= capacity) {
+        index.erase(entries.back().first);
+        entries.pop_back();
+        statistics.evictions++;
+    }
+
+    entries.emplace_front(std::move(key), std::move(result));
+    index.emplace(entries.front().first, entries.begin());
+}
+
+auto Memo::Hash::operator()(const Key& key) const -> size_t {
+    auto hash = key.size();
+    for(const auto& value : key) {
+        size_t element = 0;
+        if(value.is_string()) element = std::hash<std::string_view>{}(value.as_string());
+        else if(value.is_number()) element = std::hash<uint64_t>{}(bits(value.as_number()));
+        else if(value.is_integer()) element = std::hash<int64_t>{}(value.as_integer());
+        else if(value.is_bool()) element = value.as_bool() ? 1 : 2;
+        hash ^= element + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    }
+
+    return hash;
+}
+
+auto Memo::Equal::operator()(const Key& a, const Key& b) const -> bool {
+    // An integer and a double never match: the call could return a different kind of number.
+    // Doubles match on their bits, so -0 and 0 are told apart and NaN matches itself
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const Value& x, const Value& y) {
+        if(x.is_number() || y.is_number())
+            return x.is_number() && y.is_number() && bits(x.as_number()) == bits(y.as_number());
+        return x.is_integer() == y.is_integer() && Operators::is_equal(x, y);
+    });
+}
@@ -0,0 +1,56 @@
+/*
+ * Mint interpreter
+ * Developed by Marco Cetica (c) 2022
+ * Released under GPLv3
+ *
+ */
+#pragma once
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Value.h"
+
+/*
+ * Results of a pure function, keyed by its arguments. Only values compared
+ * by content(nil, booleans, numbers and strings) take part in keys and
+ * results. Once full, the cache evicts its least recently used entry.
+ */
+class Memo {
+public:
+    using Key = std::vector<Value>;
+    struct Stats {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t evictions = 0;
+    };
+
+    // Entries kept per function. Zero(the default) disables memoisation
+    static auto set_capacity(size_t entries) -> void;
+    static auto enabled() -> bool { return capacity != 0; }
+    // Totals for every cache
+    static auto stats() -> const Stats&;
+    static auto is_cacheable(const Value& value) -> bool;
+    static auto is_key(const Key& key) -> bool;
+
+    // Returns null on a miss
+    auto find(const Key& key) -> const Value*;
+    auto insert(Key key, Value result) -> void;
+
+private:
+    struct Hash {
+        auto operator()(const Key& key) const -> size_t;
+    };
+    struct Equal {
+        auto operator()(const Key& a, const Key& b) const -> bool;
+    };
+    using Entries = std::list<std::pair<Key, Value>>;
+
+    // Most recently used first
+    Entries entries;
+    std::unordered_map<Key, Entries::iterator, Hash, Equal> index;
+
+    static size_t capacity;
+    static Stats statistics;
+};
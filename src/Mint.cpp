@@ -1,58 +1,94 @@
-#include <fstream>
-#include <sstream>
 #include <iostream>
 #include <memory>
 #include <algorithm>
+#include <thread>
 
 #include "Mint.h"
 #include "Lexer.h"
 #include "Parser.h"
+#include "Program.h"
 #include "Interpreter.h"
 #include "MintFunction.h"
 #include "Resolver.h"
+#include "Optimizer.h"
+#include "VM.h"
+#include "ClosureCompiler.h"
+#include "Output.h"
 
 // Default error state
 bool Mint::had_error = false;
 bool Mint::had_runtime_error = false;
+engine_type Mint::engine = engine_type::INTERPRETER;
+unsigned int Mint::lexer_threads = 0;
+unsigned int Mint::optimization_level = 1;
+// Smaller scripts are lexed faster than threads can be started
+constexpr size_t PARALLEL_LEXING_SIZE = 1 << 20;
+// Every program that ran so far: the functions it declared point into its
+// syntax tree, and they can still be called(i.e., from the REPL)
+std::vector<Program> programs;
 Interpreter interpreter;
+VM vm;
+ClosureCompiler closure_compiler;
+
+auto Mint::set_engine(engine_type type) -> void {
+    engine = type;
+}
+
+auto Mint::set_lexer_threads(unsigned int threads) -> void {
+    lexer_threads = threads;
+}
+
+auto Mint::set_optimization_level(unsigned int level) -> void {
+    optimization_level = level;
+}
 
 auto Mint::run_file(const std::string &filepath) -> uint8_t {
-    std::fstream source_file(filepath, std::ios::in | std::ios::binary);
-    if(source_file.fail()) {
+    auto source = Source::from_file(filepath);
+    if(source == nullptr) {
         std::cerr << "Cannot open source file \"" << filepath << "\"." << std::endl;
         std::exit(1);
     }
 
-    std::stringstream buf;
     uint8_t exit_code = 0;
 
-    buf << source_file.rdbuf();
-    run(buf.str());
+    run(std::move(source));
 
     if(had_error) exit_code = 65;
     if(had_runtime_error) exit_code = 70;
 
-    source_file.close();
-
     return exit_code;
 }
 
 
-auto Mint::run(std::string source) -> void {
-    auto lexer(new Lexer(std::move(source)));
-    auto tokens = lexer->scan_tokens();
+auto Mint::run(std::unique_ptr<const Source> source) -> void {
+    auto text = source->text();
+    auto threads = lexer_threads != 0 ? lexer_threads : std::thread::hardware_concurrency();
+    auto tokens = text.size() >= PARALLEL_LEXING_SIZE
+            ? Lexer::scan_tokens_parallel(text, threads)
+            : Lexer(text).scan_tokens();
     Parser parser{tokens};
-    auto statements = parser.parse();
+    auto program = parser.parse();
+    program.source = std::move(source);
     // Catch syntax errors(managed by the parser)
     if(had_error) return;
 
-    Resolver resolver(interpreter);
-    resolver.resolve(statements);
+    // Only the tree interpreter runs functions on a value stack
+    Resolver resolver(engine == engine_type::INTERPRETER);
+    resolver.resolve(program.statements);
 
     // Catch execution errors(managed by the resolver)
     if(had_error) return;
 
-    interpreter.interpret(statements);
+    if(optimization_level > 0) Optimizer(program).optimize();
+
+    const auto& statements = programs.emplace_back(std::move(program)).statements;
+
+    switch(engine) {
+        case engine_type::VM: vm.interpret(statements); break;
+        case engine_type::CLOSURE: closure_compiler.interpret(statements); break;
+        default: interpreter.interpret(statements);
+    }
+    Output::flush();
 }
 
 auto Mint::run_prompt() -> void {
@@ -69,7 +105,7 @@ auto Mint::run_prompt() -> void {
             std::cout << "Exiting..." << std::endl;
             std::exit(0);
         }
-        run(user_input);
+        run(std::make_unique<const Source>(user_input));
         had_error = false;
         std::cout << "> ";
     }
@@ -85,15 +121,18 @@ auto Mint::error(const Token& token, const std::string& msg) -> void {
     if(token.type == token_type::MINT_EOF)
         report(token.line, " at end", msg);
     else
-        report(token.line, " at '" + token.lexeme + "'", msg);
+        report(token.line, " at '" + std::string(token.lexeme) + "'", msg);
 }
 
 auto Mint::report(unsigned int line, const std::string &pos, const std::string& reason) -> void {
+    // Keep errors after the output that preceded them
+    Output::flush();
     std::cerr << "[Line " << line << "] Error" << pos << ": " << reason << std::endl;
     had_error = true;
 }
 
 auto Mint::runtime_error(const RuntimeError &err) -> void {
+    Output::flush();
     std::cerr << "[Line " << err.token.line << "] " << err.what() << std::endl;
     had_runtime_error = true;
 }
\ No newline at end of file
@@ -6,24 +6,40 @@
  */
 
 #pragma once
+#include <memory>
 #include <string>
 #include "Token.h"
+#include "Source.h"
 #include "RuntimeError.h"
 #include "Interpreter.h"
 
+enum class engine_type {
+    INTERPRETER, // Tree-walking interpreter
+    VM,          // Bytecode compiler and virtual machine
+    CLOSURE      // AST compiled to native closures
+};
+
 class MintTest;
 class Mint {
     friend class MintTest;
 public:
+    static auto set_engine(engine_type type) -> void;
+    // Threads used to lex large scripts(0 picks one per core)
+    static auto set_lexer_threads(unsigned int threads) -> void;
+    // 0 runs programs as parsed, 1 optimises them first
+    static auto set_optimization_level(unsigned int level) -> void;
     static auto run_file(const std::string& filepath) -> uint8_t;
     static auto error(unsigned int line, const std::string& msg) -> void;
     static auto error(const Token& token, const std::string& msg) -> void;
     static auto runtime_error(const RuntimeError& err) -> void;
     static auto run_prompt() -> void;
 private:
-    static auto run(std::string source) -> void;
+    static auto run(std::unique_ptr<const Source> source) -> void;
     static auto report(unsigned int line, const std::string& pos, const std::string& reason) -> void;
     static bool had_error;
     static bool had_runtime_error;
+    static engine_type engine;
+    static unsigned int lexer_threads;
+    static unsigned int optimization_level;
 };
 
@@ -5,15 +5,17 @@
  *
  */
 #pragma once
-#include <any>
 #include <vector>
 #include <string>
+#include "Value.h"
 
 class Interpreter;
-class MintCallable {
+class MintCallable : public Object {
 public:
+    MintCallable() : Object(object_type::CALLABLE) {};
+    explicit MintCallable(object_type type) : Object(type) {};
     virtual unsigned short arity() = 0;
-    virtual std::any call(Interpreter& interpreter, std::vector<std::any> arguments) = 0;
-    virtual std::string to_string() = 0;
-    virtual ~MintCallable() = default;
+    // Arguments are the topmost values of the interpreter stack, starting at
+    // index 'frame'. The callee pops them before returning
+    virtual Value call(Interpreter& interpreter, size_t frame) = 0;
 };
@@ -1,27 +1,82 @@
+#include <utility>
 #include "MintFunction.h"
 #include "Environment.h"
 #include "Interpreter.h"
+#include "Memo.h"
 
 std::string MintFunction::to_string() {
-    return std::string("<fn " + declaration->name.lexeme + ">");
+    return "<fn " + std::string(declaration->name.lexeme) + ">";
 }
 
 unsigned short MintFunction::arity() {
     return declaration->params.size();
 }
 
-std::any MintFunction::call(Interpreter &interpreter, std::vector<std::any> arguments) {
-    auto env = std::make_shared<Environment>(closure);
-    for(auto i = 0UL; i < declaration->params.size(); i++)
-        env->define(declaration->params[i].lexeme, arguments[i]);
+Value MintFunction::call(Interpreter &interpreter, size_t frame) {
+    if(!declaration->pure || !Memo::enabled()) return execute(interpreter, frame);
+
+    auto& stack = interpreter.stack;
+    Memo::Key key(stack.begin() + static_cast<std::ptrdiff_t>(frame), stack.end());
+    if(!Memo::is_key(key)) return execute(interpreter, frame);
+
+    if(declaration->memo == nullptr) declaration->memo = std::make_shared<Memo>();
+    auto& memo = *declaration->memo;
+    if(auto result = memo.find(key)) {
+        stack.resize(frame);
+        return *result;
+    }
+
+    auto result = execute(interpreter, frame);
+    memo.insert(std::move(key), result);
 
-    try {
-        interpreter.execute_block(declaration->body, env);
-    } catch(MintReturn& returnValue) {
-        return returnValue.value;
+    return result;
+}
+
+auto MintFunction::execute(Interpreter& interpreter, size_t frame) -> Value {
+    auto result = invoke(interpreter, frame);
+    if(interpreter.tail_callee.is_nil()) return result;
+
+    // Calls in tail position reuse the frame, so they take no native stack
+    Value callee;
+    while(!interpreter.tail_callee.is_nil()) {
+        callee = std::exchange(interpreter.tail_callee, nullptr);
+        auto function = dynamic_cast<MintFunction*>(callee.as_object<MintCallable>());
+        if(function == nullptr) return callee.as_object<MintCallable>()->call(interpreter, frame);
+
+        result = function->invoke(interpreter, frame);
     }
 
-    return nullptr;
+    return result;
 }
 
+auto MintFunction::invoke(Interpreter& interpreter, size_t frame) -> Value {
+    auto& stack = interpreter.stack;
+    if(declaration->framed) {
+        // Parameters already sit in the first slots of the frame
+        stack.resize(frame + declaration->frame_size);
+        auto caller = std::exchange(interpreter.frame, frame);
+        auto result = interpreter.execute_block(declaration->body, closure);
+        interpreter.frame = caller;
+        interpreter.leave_frame(frame);
 
+        return result == completion::RETURN ? std::move(interpreter.return_value) : nullptr;
+    }
+
+    auto env = std::make_shared<Environment>(closure);
+    for(auto i = frame; i < stack.size(); i++)
+        env->define(std::move(stack[i]));
+    stack.resize(frame);
+
+    auto result = interpreter.execute_block(declaration->body, env);
+    interpreter.leave_frame(frame);
+
+    return result == completion::RETURN ? std::move(interpreter.return_value) : nullptr;
+}
+
+auto MintFunction::traverse(const Visitor& visit) -> void {
+    if(closure != nullptr) visit(closure.get());
+}
+
+auto MintFunction::clear() -> void {
+    closure.reset();
+}
@@ -8,24 +8,26 @@
 #include <memory>
 #include <utility>
 #include "MintCallable.h"
+#include "Collector.h"
 
 class Environment;
 struct Function;
 
-class MintReturn {
+class MintFunction : public CollectableObject<MintCallable> {
 public:
-    const std::any value;
-};
-
-class MintFunction : public MintCallable {
-public:
-    MintFunction(std::shared_ptr<Function> declaration, std::shared_ptr<Environment> closure)
-        : declaration(std::move(declaration)), closure(std::move(closure)) {};
+    MintFunction(const Function* declaration, std::shared_ptr<Environment> closure)
+        : declaration(declaration), closure(std::move(closure)) {};
     std::string to_string() override;
     unsigned short arity() override;
-    std::any call(Interpreter& interpreter, std::vector<std::any> arguments) override;
+    Value call(Interpreter& interpreter, size_t frame) override;
+    auto traverse(const Visitor& visit) -> void override;
+    auto clear() -> void override;
 private:
-    std::shared_ptr<Function> declaration;
+    auto execute(Interpreter& interpreter, size_t frame) -> Value;
+    // Runs the body once, leaving any tail call pending
+    auto invoke(Interpreter& interpreter, size_t frame) -> Value;
+
+    const Function* declaration;
     std::shared_ptr<Environment> closure;
 };
 
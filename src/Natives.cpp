@@ -0,0 +1,67 @@
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include "Natives.h"
+#include "Interpreter.h"
+
+namespace {
+    auto number(const Value& value) -> double {
+        return value.is_numeric() ? value.to_number() : std::numeric_limits<double>::quiet_NaN();
+    }
+
+    // Seconds elapsed since an arbitrary point, for timing scripts
+    auto native_clock(const Value*) -> Value {
+        auto elapsed = std::chrono::steady_clock::now().time_since_epoch();
+        return std::chrono::duration<double>(elapsed).count();
+    }
+
+    auto native_sqrt(const Value* arguments) -> Value {
+        return std::sqrt(number(arguments[0]));
+    }
+
+    auto native_floor(const Value* arguments) -> Value {
+        if(arguments[0].is_integer()) return arguments[0];
+        return std::floor(number(arguments[0]));
+    }
+
+    auto native_len(const Value* arguments) -> Value {
+        if(!arguments[0].is_string()) return nullptr;
+        return static_cast<int64_t>(arguments[0].as_string().size());
+    }
+}
+
+std::string MintNative::to_string() {
+    return "<native fn " + std::string(name) + ">";
+}
+
+unsigned short MintNative::arity() {
+    return params;
+}
+
+Value MintNative::call(Interpreter& interpreter, size_t frame) {
+    auto& stack = interpreter.stack;
+    auto result = function(stack.data() + frame);
+    stack.resize(frame);
+
+    return result;
+}
+
+auto Natives::registry() -> const std::vector<Value>& {
+    static const std::vector<Value> natives = {
+        Value(new MintNative("clock", 0, false, native_clock)),
+        Value(new MintNative("sqrt", 1, true, native_sqrt)),
+        Value(new MintNative("floor", 1, true, native_floor)),
+        Value(new MintNative("len", 1, true, native_len)),
+    };
+
+    return natives;
+}
+
+auto Natives::find(Symbol name) -> const MintNative* {
+    for(const auto& native : registry()) {
+        auto function = native.as_object<MintNative>();
+        if(function->name == name->chars()) return function;
+    }
+
+    return nullptr;
+}
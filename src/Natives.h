@@ -0,0 +1,44 @@
+/*
+ * Mint interpreter
+ * Developed by Marco Cetica (c) 2022
+ * Released under GPLv3
+ *
+ */
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include "MintCallable.h"
+#include "Interner.h"
+
+/*
+ * Built-in function implemented in C++. Natives take a fixed number of
+ * arguments, read from a contiguous array, and never fail: like their
+ * JavaScript counterparts they return NaN or nil for unexpected operands.
+ */
+class MintNative : public MintCallable {
+public:
+    using Function = Value (*)(const Value* arguments);
+    // Arguments of a native call fit in a local array
+    static constexpr unsigned short MAX_ARITY = 4;
+
+    MintNative(std::string_view name, unsigned short params, bool pure, Function function)
+        : MintCallable(object_type::NATIVE), name(name), params(params), pure(pure), function(function) {};
+    std::string to_string() override;
+    unsigned short arity() override;
+    Value call(Interpreter& interpreter, size_t frame) override;
+
+    const std::string_view name;
+    const unsigned short params;
+    // Whether the result depends only on the arguments
+    const bool pure;
+    const Function function;
+};
+
+// Every native function. Engines bind them as globals when they are created
+class Natives {
+public:
+    static auto registry() -> const std::vector<Value>&;
+    // Returns null if there is no native with the given name
+    static auto find(Symbol name) -> const MintNative*;
+};
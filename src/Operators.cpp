@@ -0,0 +1,207 @@
+#include <charconv>
+#include <cmath>
+#include <iterator>
+#include "Operators.h"
+#include "RuntimeError.h"
+
+auto Operators::binary(const Token& op, const Value& left, const Value& right) -> Value {
+    switch (op.type) {
+        case token_type::BANG_EQUAL: return !is_equal(left, right);
+        case token_type::EQUAL_EQUAL: return is_equal(left, right);
+        case token_type::PLUS:
+            if(left.is_string() && right.is_string())
+                return Value(MintString::concat(left.as_object<MintString>(), right.as_object<MintString>()));
+            if(!left.is_numeric() || !right.is_numeric())
+                throw RuntimeError(op, "Operands must be two numbers or two strings.");
+
+            return arithmetic(op, left, right);
+        case token_type::GREATER: case token_type::GREATER_EQUAL:
+        case token_type::LESS: case token_type::LESS_EQUAL:
+        case token_type::MINUS: case token_type::SLASH:
+        case token_type::STAR: case token_type::MODULO:
+            check_number_operands(op, left, right);
+            return arithmetic(op, left, right);
+        case token_type::BIT_AND:
+            check_number_operands(op, left, right);
+            return to_integer(left) & to_integer(right);
+        case token_type::BIT_OR:
+            check_number_operands(op, left, right);
+            return to_integer(left) | to_integer(right);
+        case token_type::XOR:
+            check_number_operands(op, left, right);
+            return to_integer(left) ^ to_integer(right);
+        case token_type::LEFT_SHIFT:
+            check_number_operands(op, left, right);
+            return shift_left(to_integer(left), to_integer(right));
+        case token_type::RIGHT_SHIFT:
+            check_number_operands(op, left, right);
+            return shift_right(to_integer(left), to_integer(right));
+        default: break;
+    }
+
+    return {};
+}
+
+// Arithmetic and comparisons of two numbers: integers stay integers
+// unless one of the operands is a double
+auto Operators::arithmetic(const Token& op, const Value& left, const Value& right) -> Value {
+    if(left.is_integer() && right.is_integer()) {
+        auto a = left.as_integer();
+        auto b = right.as_integer();
+        switch(op.type) {
+            case token_type::GREATER: return a > b;
+            case token_type::GREATER_EQUAL: return a >= b;
+            case token_type::LESS: return a < b;
+            case token_type::LESS_EQUAL: return a <= b;
+            case token_type::PLUS: return add(a, b);
+            case token_type::MINUS: return subtract(a, b);
+            case token_type::STAR: return multiply(a, b);
+            case token_type::MODULO: return modulo(a, b);
+            default: break;
+        }
+    }
+
+    auto a = left.to_number();
+    auto b = right.to_number();
+    switch(op.type) {
+        case token_type::PLUS: return a + b;
+        case token_type::MINUS: return a - b;
+        case token_type::SLASH: return a / b;
+        case token_type::STAR: return a * b;
+        case token_type::MODULO: return std::fmod(a, b);
+        default: break;
+    }
+
+    // Integers do not always convert to doubles exactly: order them as they are
+    if(left.is_integer() != right.is_integer()) {
+        a = left.is_integer() ? compare(left.as_integer(), b) : -compare(right.as_integer(), a);
+        b = 0;
+    }
+    switch(op.type) {
+        case token_type::GREATER: return a > b;
+        case token_type::GREATER_EQUAL: return a >= b;
+        case token_type::LESS: return a < b;
+        case token_type::LESS_EQUAL: return a <= b;
+        default: break;
+    }
+
+    return {};
+}
+
+auto Operators::unary(const Token& op, const Value& right) -> Value {
+    switch (op.type) {
+        case token_type::BANG: return !is_truthy(right);
+        case token_type::MINUS:
+            check_number_operand(op, right);
+            if(right.is_integer()) return negate(right.as_integer());
+            return -right.as_number();
+        case token_type::NOT:
+            check_number_operand(op, right);
+            return ~to_integer(right);
+        default: break;
+    }
+
+    return {};
+}
+
+auto Operators::modulo(int64_t a, int64_t b) -> Value {
+    // Same results as fmod: NaN for a zero divisor, the sign of the dividend
+    if(b == 0) return std::fmod(static_cast<double>(a), 0.0);
+    if(b == -1) b = 1;
+    auto result = a % b;
+    if(result == 0 && a < 0) return -0.0;
+
+    return result;
+}
+
+auto Operators::compare(int64_t a, double b) -> double {
+    // 2^63, the bounds of the integers as doubles
+    constexpr auto limit = 9223372036854775808.0;
+    if(std::isnan(b)) return b;
+    if(b >= limit) return -1;
+    if(b < -limit) return 1;
+
+    auto whole = static_cast<int64_t>(b);
+    if(a != whole) return a < whole ? -1 : 1;
+    auto fraction = b - static_cast<double>(whole);
+
+    return fraction > 0 ? -1 : fraction < 0 ? 1 : 0;
+}
+
+auto Operators::to_integer(const Value& number) -> int64_t {
+    if(number.is_integer()) return number.as_integer();
+
+    auto value = std::fmod(std::trunc(number.as_number()), 18446744073709551616.0);
+    if(!std::isfinite(value)) return 0;
+    auto magnitude = static_cast<uint64_t>(std::fabs(value));
+
+    return static_cast<int64_t>(value < 0 ? -magnitude : magnitude);
+}
+
+auto Operators::check_number_operand(const Token &op, const Value &operand) -> void {
+    if(operand.is_numeric()) return;
+    throw RuntimeError(op, "Operand must be a number.");
+}
+
+auto Operators::check_number_operands(const Token &op, const Value &left, const Value &right) -> void {
+    if(left.is_numeric() && right.is_numeric()) return;
+
+    throw RuntimeError(op, "Operands must be numbers.");
+}
+
+auto Operators::is_truthy(const Value &object) -> bool {
+    if(object.is_nil()) return false;
+    if(object.is_bool())
+        return object.as_bool();
+
+    return true;
+}
+
+auto Operators::is_equal(const Value &a, const Value &b) -> bool {
+    if(a.is_nil() && b.is_nil()) return true;
+    if(a.is_nil()) return false;
+    if(a.is_string() && b.is_string()) {
+        auto left = a.as_object<MintString>();
+        auto right = b.as_object<MintString>();
+        if(left == right) return true;
+        if(left->interned && right->interned) return false;
+
+        return left->chars() == right->chars();
+    }
+    if(a.is_integer() && b.is_integer())
+        return a.as_integer() == b.as_integer();
+    if(a.is_integer() && b.is_number())
+        return compare(a.as_integer(), b.as_number()) == 0;
+    if(a.is_number() && b.is_integer())
+        return compare(b.as_integer(), a.as_number()) == 0;
+    if(a.is_number() && b.is_number())
+        return a.as_number() == b.as_number();
+    if(a.is_bool() && b.is_bool())
+        return a.as_bool() == b.as_bool();
+
+    return false;
+}
+
+auto Operators::format(const Value& number, char (&chars)[NUMBER_CHARS]) -> std::string_view {
+    auto result = number.is_integer()
+            ? std::to_chars(std::begin(chars), std::end(chars), number.as_integer())
+            : std::to_chars(std::begin(chars), std::end(chars), number.as_number());
+
+    return {chars, static_cast<size_t>(result.ptr - chars)};
+}
+
+auto Operators::stringify(const Value &object) -> std::string {
+    if(object.is_nil()) return "nil";
+    if(object.is_numeric()) {
+        char chars[NUMBER_CHARS];
+        return std::string(format(object, chars));
+    }
+    if(object.is_string())
+        return std::string(object.as_string());
+    if(object.is_bool())
+        return object.as_bool() ? "true" : "false";
+    if(object.is_object())
+        return object.as_object()->to_string();
+
+    return "Error in 'stringify': object type not supported.";
+}
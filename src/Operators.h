@@ -0,0 +1,76 @@
+/*
+ * Mint interpreter
+ * Developed by Marco Cetica (c) 2022
+ * Released under GPLv3
+ *
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "Token.h"
+#include "Value.h"
+
+/*
+ * Semantics of Mint operators, shared by every execution engine.
+ * The operator token selects the operation and is also used to
+ * report runtime errors.
+ */
+class Operators {
+public:
+    static auto binary(const Token& op, const Value& left, const Value& right) -> Value;
+    static auto unary(const Token& op, const Value& right) -> Value;
+    static auto is_truthy(const Value& object) -> bool;
+    static auto is_equal(const Value& a, const Value& b) -> bool;
+    static auto stringify(const Value& object) -> std::string;
+    // Longest text of a number
+    static constexpr size_t NUMBER_CHARS = 32;
+    // Writes the shortest text that reads back as the same number into 'chars'
+    static auto format(const Value& number, char (&chars)[NUMBER_CHARS]) -> std::string_view;
+
+    // Integer arithmetic. Results that do not fit in 64 bits, and the
+    // negative zeros that doubles would produce, are returned as doubles
+    static auto add(int64_t a, int64_t b) -> Value {
+        int64_t result;
+        if(__builtin_add_overflow(a, b, &result)) return static_cast<double>(a) + static_cast<double>(b);
+        return result;
+    }
+    static auto subtract(int64_t a, int64_t b) -> Value {
+        int64_t result;
+        if(__builtin_sub_overflow(a, b, &result)) return static_cast<double>(a) - static_cast<double>(b);
+        return result;
+    }
+    static auto multiply(int64_t a, int64_t b) -> Value {
+        int64_t result;
+        if(__builtin_mul_overflow(a, b, &result) || (result == 0 && (a < 0 || b < 0)))
+            return static_cast<double>(a) * static_cast<double>(b);
+        return result;
+    }
+    static auto divide(int64_t a, int64_t b) -> Value {
+        return static_cast<double>(a) / static_cast<double>(b);
+    }
+    static auto modulo(int64_t a, int64_t b) -> Value;
+    static auto negate(int64_t a) -> Value {
+        if(a == 0 || a == INT64_MIN) return -static_cast<double>(a);
+        return -a;
+    }
+    // Exact ordering of an integer and a double: -1, 0 or 1 as their
+    // difference would be, NaN if they are unordered
+    static auto compare(int64_t a, double b) -> double;
+    // Bitwise operators work on 64-bit integers: doubles are truncated
+    // and wrapped modulo 2^64
+    static auto to_integer(const Value& number) -> int64_t;
+    // Shift counts wrap around the width of the operand
+    static auto shift_left(int64_t a, int64_t b) -> Value {
+        return static_cast<int64_t>(static_cast<uint64_t>(a) << (b & 63));
+    }
+    static auto shift_right(int64_t a, int64_t b) -> Value {
+        return a >> (b & 63);
+    }
+
+private:
+    static auto check_number_operand(const Token& op, const Value& operand) -> void;
+    static auto check_number_operands(const Token& op, const Value& left, const Value& right) -> void;
+    static auto arithmetic(const Token& op, const Value& left, const Value& right) -> Value;
+};
@@ -0,0 +1,240 @@
+#include "Optimizer.h"
+#include "Operators.h"
+#include "RuntimeError.h"
+
+
+static Optimizer::Stats optimizer_stats;
+
+static auto is_literal(const Expr* expr) -> bool {
+    return dynamic_cast<const Literal*>(expr) != nullptr;
+}
+
+static auto literal(const Expr* expr) -> const Value& {
+    return static_cast<const Literal*>(expr)->value;
+}
+
+auto Optimizer::optimize() -> void {
+    program.statements = optimize(program.statements);
+}
+
+auto Optimizer::stats() -> const Stats& {
+    return optimizer_stats;
+}
+
+auto Optimizer::optimize(Expr* expr) -> Expr* {
+    expr->accept(*this);
+
+    return expr_result;
+}
+
+auto Optimizer::optimize(Stmt* stmt) -> Stmt* {
+    stmt->accept(*this);
+
+    return stmt_result;
+}
+
+auto Optimizer::optimize(const std::vector<Stmt*>& statements) -> std::vector<Stmt*> {
+    std::vector<Stmt*> optimized;
+    optimized.reserve(statements.size());
+    for(const auto& stmt : statements) {
+        auto result = optimize(stmt);
+        if(result != nullptr) optimized.push_back(result);
+    }
+
+    return optimized;
+}
+
+auto Optimizer::optimize_required(Stmt* stmt) -> Stmt* {
+    auto result = optimize(stmt);
+
+    return result != nullptr ? result : make<Block>(std::vector<Stmt*>{}, false);
+}
+
+auto Optimizer::fold(Value value) -> Expr* {
+    optimizer_stats.folded++;
+
+    return make<Literal>(std::move(value));
+}
+
+void Optimizer::visit_block_stmt(Block& stmt) {
+    auto statements = optimize(stmt.statements);
+    stmt_result = statements != stmt.statements ? make<Block>(std::move(statements), stmt.scoped) : &stmt;
+}
+
+void Optimizer::visit_expression_stmt(Expression& stmt) {
+    auto expression = optimize(stmt.expression);
+    stmt_result = expression != stmt.expression ? make<Expression>(expression) : &stmt;
+}
+
+void Optimizer::visit_function_stmt(Function& stmt) {
+    auto body = optimize(stmt.body);
+    if(body == stmt.body) {
+        stmt_result = &stmt;
+        return;
+    }
+
+    auto function = make<Function>(stmt.name, stmt.params, std::move(body));
+    function->framed = stmt.framed;
+    function->frame_size = stmt.frame_size;
+    function->pure = stmt.pure;
+    stmt_result = function;
+}
+
+void Optimizer::visit_if_stmt(If& stmt) {
+    auto condition = optimize(stmt.condition);
+    if(is_literal(condition)) {
+        // Only one branch can ever run
+        optimizer_stats.pruned++;
+        auto branch = Operators::is_truthy(literal(condition)) ? stmt.then_branch : stmt.else_branch;
+        stmt_result = branch != nullptr ? optimize(branch) : nullptr;
+        return;
+    }
+
+    auto then_branch = optimize_required(stmt.then_branch);
+    auto else_branch = stmt.else_branch != nullptr ? optimize(stmt.else_branch) : nullptr;
+    auto changed = condition != stmt.condition || then_branch != stmt.then_branch || else_branch != stmt.else_branch;
+    stmt_result = changed ? make<If>(condition, then_branch, else_branch) : &stmt;
+}
+
+void Optimizer::visit_print_stmt(Print& stmt) {
+    auto expression = optimize(stmt.expression);
+    stmt_result = expression != stmt.expression ? make<Print>(expression) : &stmt;
+}
+
+void Optimizer::visit_return_stmt(Return& stmt) {
+    auto value = stmt.value != nullptr ? optimize(stmt.value) : nullptr;
+    if(value == stmt.value) {
+        stmt_result = &stmt;
+        return;
+    }
+
+    auto ret = make<Return>(stmt.keyword, value);
+    ret->tail = stmt.tail && dynamic_cast<Call*>(value) != nullptr;
+    stmt_result = ret;
+}
+
+void Optimizer::visit_variable_stmt(Var& stmt) {
+    auto initializer = stmt.initializer != nullptr ? optimize(stmt.initializer) : nullptr;
+    // Locals that keep their initial value for their whole lifetime
+    if(!stmt.reassigned && (initializer == nullptr || is_literal(initializer)))
+        constants.emplace(&stmt, initializer != nullptr ? literal(initializer) : Value());
+    // The declaration stays: it still owns a slot of its scope
+    if(initializer == stmt.initializer) {
+        stmt_result = &stmt;
+        return;
+    }
+
+    auto var = make<Var>(stmt.name, initializer);
+    var->reassigned = stmt.reassigned;
+    var->frame_slot = stmt.frame_slot;
+    stmt_result = var;
+}
+
+void Optimizer::visit_while_stmt(While& stmt) {
+    auto condition = optimize(stmt.condition);
+    if(is_literal(condition) && !Operators::is_truthy(literal(condition))) {
+        optimizer_stats.pruned++;
+        stmt_result = nullptr;
+        return;
+    }
+
+    auto body = optimize_required(stmt.body);
+    stmt_result = condition != stmt.condition || body != stmt.body ? make<While>(condition, body) : &stmt;
+}
+
+Value Optimizer::visit_assign_expr(Assign& expr) {
+    auto value = optimize(expr.value);
+    expr_result = &expr;
+    if(value != expr.value) {
+        auto assign = make<Assign>(expr.name, value);
+        assign->resolved = expr.resolved;
+        expr_result = assign;
+    }
+
+    return {};
+}
+
+Value Optimizer::visit_binary_expr(Binary& expr) {
+    auto left = optimize(expr.left);
+    auto right = optimize(expr.right);
+    if(is_literal(left) && is_literal(right)) {
+        try {
+            expr_result = fold(Operators::binary(expr.op, literal(left), literal(right)));
+            return {};
+        } catch(const RuntimeError&) {
+            // Not a valid operation: it fails when(and if) it runs
+        }
+    }
+
+    expr_result = left != expr.left || right != expr.right ? make<Binary>(left, expr.op, right) : &expr;
+
+    return {};
+}
+
+Value Optimizer::visit_call_expr(Call& expr) {
+    auto callee = optimize(expr.callee);
+    auto arguments = std::vector<Expr*>();
+    arguments.reserve(expr.arguments.size());
+    for(const auto& argument : expr.arguments) arguments.push_back(optimize(argument));
+
+    auto changed = callee != expr.callee || arguments != expr.arguments;
+    expr_result = changed ? make<Call>(callee, expr.paren, std::move(arguments)) : &expr;
+
+    return {};
+}
+
+Value Optimizer::visit_grouping_expr(Grouping& expr) {
+    // Parentheses only matter to the parser
+    expr_result = optimize(expr.expr);
+
+    return {};
+}
+
+Value Optimizer::visit_literal_expr(Literal& expr) {
+    expr_result = &expr;
+    return {};
+}
+
+Value Optimizer::visit_logical_expr(Logical& expr) {
+    auto left = optimize(expr.left);
+    if(is_literal(left)) {
+        // The left operand alone decides whether the right one is evaluated
+        auto truthy = Operators::is_truthy(literal(left));
+        auto short_circuit = expr.op.type == token_type::OR ? truthy : !truthy;
+        optimizer_stats.folded++;
+        expr_result = short_circuit ? left : optimize(expr.right);
+        return {};
+    }
+
+    auto right = optimize(expr.right);
+    expr_result = left != expr.left || right != expr.right ? make<Logical>(left, expr.op, right) : &expr;
+
+    return {};
+}
+
+Value Optimizer::visit_unary_expr(Unary& expr) {
+    auto right = optimize(expr.right);
+    if(is_literal(right)) {
+        try {
+            expr_result = fold(Operators::unary(expr.op, literal(right)));
+            return {};
+        } catch(const RuntimeError&) {
+            // Not a valid operation: it fails when(and if) it runs
+        }
+    }
+
+    expr_result = right != expr.right ? make<Unary>(expr.op, right) : &expr;
+
+    return {};
+}
+
+Value Optimizer::visit_variable_expr(Variable& expr) {
+    expr_result = &expr;
+    auto constant = constants.find(expr.resolved.declaration);
+    if(constant != constants.end()) {
+        optimizer_stats.propagated++;
+        expr_result = make<Literal>(constant->second);
+    }
+
+    return {};
+}
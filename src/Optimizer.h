@@ -0,0 +1,73 @@
+/*
+ * Mint interpreter
+ * Developed by Marco Cetica (c) 2022
+ * Released under GPLv3
+ *
+ */
+#pragma once
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+#include "Stmt.h"
+#include "Program.h"
+
+/*
+ * Rewrites a resolved program before it runs:
+ *  - operators whose operands are literals are evaluated(folding);
+ *  - reads of local variables declared with a literal value and never
+ *    assigned again are replaced by that value(propagation);
+ *  - branches and loops whose condition is a literal are pruned.
+ * Nodes are never modified: changed subtrees are rebuilt in the program
+ * arena. Expressions that would fail at runtime are left untouched, so
+ * errors are still reported when(and if) they are evaluated.
+ */
+class Optimizer : public ExprVisitor, public StmtVisitor {
+public:
+    struct Stats {
+        size_t folded = 0;
+        size_t propagated = 0;
+        size_t pruned = 0;
+    };
+
+    explicit Optimizer(Program& program) : program(program) {};
+    auto optimize() -> void;
+    // Totals for every program optimised so far
+    static auto stats() -> const Stats&;
+    // Stmt abstract class
+    void visit_block_stmt(Block& stmt) override;
+    void visit_expression_stmt(Expression& stmt) override;
+    void visit_function_stmt(Function& stmt) override;
+    void visit_if_stmt(If& stmt) override;
+    void visit_print_stmt(Print& stmt) override;
+    void visit_return_stmt(Return& stmt) override;
+    void visit_variable_stmt(Var& stmt) override;
+    void visit_while_stmt(While& stmt) override;
+    // Expr abstract class
+    Value visit_assign_expr(Assign& expr) override;
+    Value visit_binary_expr(Binary& expr) override;
+    Value visit_call_expr(Call& expr) override;
+    Value visit_grouping_expr(Grouping& expr) override;
+    Value visit_literal_expr(Literal& expr) override;
+    Value visit_logical_expr(Logical& expr) override;
+    Value visit_unary_expr(Unary& expr) override;
+    Value visit_variable_expr(Variable& expr) override;
+
+private:
+    auto optimize(Expr* expr) -> Expr*;
+    // Returns null when the statement can be dropped
+    auto optimize(Stmt* stmt) -> Stmt*;
+    auto optimize(const std::vector<Stmt*>& statements) -> std::vector<Stmt*>;
+    // Statement in a position that cannot be left empty(i.e., a loop body)
+    auto optimize_required(Stmt* stmt) -> Stmt*;
+    auto fold(Value value) -> Expr*;
+    template<class T, class... Args>
+    auto make(Args&&... args) -> T* {
+        return program.arena.make<T>(std::forward<Args>(args)...);
+    }
+
+    Program& program;
+    Expr* expr_result = nullptr;
+    Stmt* stmt_result = nullptr;
+    // Values of the constant locals seen so far
+    std::unordered_map<const Var*, Value> constants;
+};
@@ -0,0 +1,59 @@
+#include <cerrno>
+#include <iostream>
+#include <unistd.h>
+#include "Output.h"
+#include "Operators.h"
+
+std::string Output::buffer;
+flush_policy Output::policy = isatty(STDOUT_FILENO) ? flush_policy::LINE : flush_policy::BLOCK;
+int Output::fd = -1;
+
+auto Output::print(const Value& value) -> void {
+    if(value.is_string()) {
+        buffer.append(value.as_string());
+    } else if(value.is_numeric()) {
+        char chars[Operators::NUMBER_CHARS];
+        buffer.append(Operators::format(value, chars));
+    } else {
+        buffer.append(Operators::stringify(value));
+    }
+    buffer.push_back('\n');
+
+    if(policy == flush_policy::LINE || buffer.size() >= BLOCK_SIZE) flush();
+}
+
+auto Output::flush() -> void {
+    if(buffer.empty()) return;
+
+    write(buffer);
+    buffer.clear();
+}
+
+auto Output::set_policy(flush_policy value) -> void {
+    policy = value;
+    if(policy == flush_policy::LINE) flush();
+}
+
+auto Output::redirect(int descriptor) -> void {
+    flush();
+    fd = descriptor;
+    policy = isatty(fd < 0 ? STDOUT_FILENO : fd) ? flush_policy::LINE : flush_policy::BLOCK;
+}
+
+auto Output::write(std::string_view chars) -> void {
+    if(fd < 0) {
+        std::cout.write(chars.data(), static_cast<std::streamsize>(chars.size()));
+        std::cout.flush();
+        return;
+    }
+
+    while(!chars.empty()) {
+        auto written = ::write(fd, chars.data(), chars.size());
+        if(written < 0) {
+            if(errno == EINTR) continue;
+            // Nowhere left to report the output to
+            return;
+        }
+        chars.remove_prefix(static_cast<size_t>(written));
+    }
+}
@@ -0,0 +1,44 @@
+/*
+ * Mint interpreter
+ * Developed by Marco Cetica (c) 2022
+ * Released under GPLv3
+ *
+ */
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include "Value.h"
+
+enum class flush_policy {
+    LINE, // Flush after every printed line
+    BLOCK // Flush when the buffer fills up
+};
+
+/*
+ * Destination of print statements. Printed values are formatted straight
+ * into a buffer, which is written out according to the flush policy and
+ * whenever a program finishes or reports an error. Output goes to the
+ * standard output stream unless it is redirected to a file descriptor.
+ * Terminals are line buffered, anything else is block buffered.
+ */
+class Output {
+public:
+    // Bytes collected before a block buffered sink is flushed
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+    static auto print(const Value& value) -> void;
+    static auto flush() -> void;
+    static auto set_policy(flush_policy policy) -> void;
+    // Writes to 'fd' instead of the standard output stream(-1 to restore it)
+    // and resets the flush policy to the default for the new sink
+    static auto redirect(int fd) -> void;
+
+private:
+    static auto write(std::string_view chars) -> void;
+
+    static std::string buffer;
+    static flush_policy policy;
+    // -1 for the standard output stream
+    static int fd;
+};
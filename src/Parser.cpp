@@ -3,20 +3,18 @@
 
 #include <cassert>
 
-auto Parser::parse() -> std::vector<std::shared_ptr<Stmt>> {
-    std::vector<std::shared_ptr<Stmt>> statements;
-
+auto Parser::parse() -> Program {
     while(!is_at_end())
-        statements.push_back(declaration());
+        program.statements.push_back(declaration());
 
-    return statements;
+    return std::move(program);
 }
 
-auto Parser::expression() -> std::shared_ptr<Expr> {
+auto Parser::expression() -> Expr* {
     return assignment();
 }
 
-auto Parser::declaration() -> std::shared_ptr<Stmt> {
+auto Parser::declaration() -> Stmt* {
     try {
         if(match(token_type::FN)) return function("function");
         if(match(token_type::LET)) return var_declaration();
@@ -27,53 +25,53 @@ auto Parser::declaration() -> std::shared_ptr<Stmt> {
     }
 }
 
-auto Parser::statement() -> std::shared_ptr<Stmt> {
+auto Parser::statement() -> Stmt* {
     if(match(token_type::FOR)) return for_statement();
     if(match(token_type::IF)) return if_statement();
     if(match(token_type::PRINT)) return print_statement();
     if(match(token_type::RETURN)) return return_statement();
     if(match(token_type::WHILE)) return while_statement();
-    if(match(token_type::LEFT_BRACE)) return std::make_shared<Block>(block());
+    if(match(token_type::LEFT_BRACE)) return make<Block>(block());
 
     return expression_statement();
 }
 
-auto Parser::for_statement() -> std::shared_ptr<Stmt> {
+auto Parser::for_statement() -> Stmt* {
     consume(token_type::LEFT_PAREN, "Expect '(' after for");
 
-    std::shared_ptr<Stmt> initializer;
+    Stmt* initializer;
     if(match(token_type::SEMICOLON)) initializer = nullptr;
     else if(match(token_type::LET)) initializer = var_declaration();
     else initializer = expression_statement();
 
-    std::shared_ptr<Expr> cond = nullptr;
+    Expr* cond = nullptr;
     if(!check(token_type::SEMICOLON)) cond = expression();
     consume(token_type::SEMICOLON, "Expect ';' after loop condition.");
 
-    std::shared_ptr<Expr> increment = nullptr;
+    Expr* increment = nullptr;
     if(!check(token_type::RIGHT_PAREN)) increment = expression();
     consume(token_type::RIGHT_PAREN, "Expect ')' after for clauses.");
-    std::shared_ptr<Stmt> body = statement();
+    Stmt* body = statement();
 
     if(increment != nullptr) {
-        body = std::make_shared<Block>(
-                std::vector<std::shared_ptr<Stmt>>{
+        body = make<Block>(
+                std::vector<Stmt*>{
                         body,
-                        std::make_shared<Expression>(increment)});
+                        make<Expression>(increment)});
     }
 
     if(cond == nullptr)
-        cond = std::make_shared<Literal>(true);
-    body = std::make_shared<While>(cond, body);
+        cond = make<Literal>(true);
+    body = make<While>(cond, body);
 
     if(initializer != nullptr)
-        body = std::make_shared<Block>(
-                std::vector<std::shared_ptr<Stmt>>{initializer, body});
+        body = make<Block>(
+                std::vector<Stmt*>{initializer, body});
 
     return body;
 }
 
-auto Parser::function(std::string kind) -> std::shared_ptr<Function> {
+auto Parser::function(std::string kind) -> Function* {
     Token name = consume(token_type::IDENTIFIER, "Expect " + kind + " name.");
     consume(token_type::LEFT_PAREN, "Expect '(' after " + kind + " name.");
     std::vector<Token> parameters;
@@ -87,24 +85,24 @@ auto Parser::function(std::string kind) -> std::shared_ptr<Function> {
     }
     consume(token_type::RIGHT_PAREN, "Expect ')' after parameters.");
     consume(token_type::LEFT_BRACE, "Expect '{' before " + kind + " body.");
-    std::vector<std::shared_ptr<Stmt>> body = block();
+    std::vector<Stmt*> body = block();
 
-    return std::make_shared<Function>(std::move(name), std::move(parameters), std::move(body));
+    return make<Function>(std::move(name), std::move(parameters), std::move(body));
 }
 
 
-auto Parser::return_statement() -> std::shared_ptr<Stmt> {
+auto Parser::return_statement() -> Stmt* {
     Token keyword = previous();
-    std::shared_ptr<Expr> value = nullptr;
+    Expr* value = nullptr;
     if(!check(token_type::SEMICOLON)) value = expression();
 
     consume(token_type::SEMICOLON, "Expect ';' after return value.");
 
-    return std::make_shared<Return>(keyword, value);
+    return make<Return>(keyword, value);
 }
 
-auto Parser::call() -> std::shared_ptr<Expr> {
-    std::shared_ptr<Expr> expr = primary();
+auto Parser::call() -> Expr* {
+    Expr* expr = primary();
 
     while(true) {
         if(match(token_type::LEFT_PAREN)) expr = finish_call(expr);
@@ -114,8 +112,8 @@ auto Parser::call() -> std::shared_ptr<Expr> {
     return expr;
 }
 
-auto Parser::finish_call(const std::shared_ptr<Expr>& callee) -> std::shared_ptr<Expr> {
-    std::vector<std::shared_ptr<Expr>> arguments;
+auto Parser::finish_call(Expr* callee) -> Expr* {
+    std::vector<Expr*> arguments;
     if(!check(token_type::RIGHT_PAREN)) {
         do {
             if(arguments.size() >= 255)
@@ -126,79 +124,79 @@ auto Parser::finish_call(const std::shared_ptr<Expr>& callee) -> std::shared_ptr
 
     Token paren = consume(token_type::RIGHT_PAREN, "Expect ')' after arguments.");
 
-    return std::make_shared<Call>(callee, std::move(paren), std::move(arguments));
+    return make<Call>(callee, std::move(paren), std::move(arguments));
 }
-auto Parser::and_expression() -> std::shared_ptr<Expr> {
-    std::shared_ptr<Expr> expr = equality();
+auto Parser::and_expression() -> Expr* {
+    Expr* expr = equality();
 
     while(match(token_type::AND)) {
         Token op = previous();
-        std::shared_ptr<Expr> right = equality();
-        expr = std::make_shared<Logical>(expr, std::move(op), right);
+        Expr* right = equality();
+        expr = make<Logical>(expr, std::move(op), right);
     }
 
     return expr;
 }
-auto Parser::or_expression() -> std::shared_ptr<Expr> {
-    std::shared_ptr<Expr> expr = and_expression();
+auto Parser::or_expression() -> Expr* {
+    Expr* expr = and_expression();
 
     while(match(token_type::OR)) {
         Token op = previous();
-        std::shared_ptr<Expr> right = and_expression();
-        expr = std::make_shared<Logical>(expr, std::move(op), right);
+        Expr* right = and_expression();
+        expr = make<Logical>(expr, std::move(op), right);
     }
 
     return expr;
 }
 
-auto Parser::expression_statement() -> std::shared_ptr<Stmt> {
-    std::shared_ptr<Expr> expr = expression();
+auto Parser::expression_statement() -> Stmt* {
+    Expr* expr = expression();
     consume(token_type::SEMICOLON, "Expect ';' after expression.");
 
-    return std::make_shared<Expression>(expr);
+    return make<Expression>(expr);
 }
 
-auto Parser::if_statement() -> std::shared_ptr<Stmt> {
+auto Parser::if_statement() -> Stmt* {
     consume(token_type::LEFT_PAREN, "Expect '(' after if.");
-    std::shared_ptr<Expr> cond = expression();
+    Expr* cond = expression();
     consume(token_type::RIGHT_PAREN, "Expect ')' after if condition.");
 
-    std::shared_ptr<Stmt> then_branch = statement();
-    std::shared_ptr<Stmt> else_branch = nullptr;
+    Stmt* then_branch = statement();
+    Stmt* else_branch = nullptr;
     if(match(token_type::ELSE)) else_branch = statement();
 
-    return std::make_shared<If>(cond, then_branch, else_branch);
+    return make<If>(cond, then_branch, else_branch);
 }
 
-auto Parser::while_statement() -> std::shared_ptr<Stmt> {
+auto Parser::while_statement() -> Stmt* {
     consume(token_type::LEFT_PAREN, "Expect '(' after while.");
-    std::shared_ptr<Expr> cond = expression();
+    Expr* cond = expression();
     consume(token_type::RIGHT_PAREN, "Expect ')' after condition.");
-    std::shared_ptr<Stmt> body = statement();
+    Stmt* body = statement();
 
-    return std::make_shared<While>(cond, body);
+    return make<While>(cond, body);
 }
 
-auto Parser::print_statement() -> std::shared_ptr<Stmt> {
+auto Parser::print_statement() -> Stmt* {
     auto value = expression();
     consume(token_type::SEMICOLON, "Expect ';' after value.");
 
-    return std::make_shared<Print>(value);
+    return make<Print>(value);
 }
 
-auto Parser::var_declaration() -> std::shared_ptr<Stmt> {
+auto Parser::var_declaration() -> Stmt* {
     auto name = consume(token_type::IDENTIFIER, "Expect variable name.");
 
-    std::shared_ptr<Expr> initializer = nullptr;
+    Expr* initializer = nullptr;
     if(match(token_type::EQUAL))
         initializer = expression();
 
     consume(token_type::SEMICOLON, "Expect ';' after variable declaration.");
-    return std::make_shared<Var>(std::move(name), initializer);
+    return make<Var>(std::move(name), initializer);
 }
 
-auto Parser::block() -> std::vector<std::shared_ptr<Stmt>> {
-    std::vector<std::shared_ptr<Stmt>> statements;
+auto Parser::block() -> std::vector<Stmt*> {
+    std::vector<Stmt*> statements;
 
     while(!check(token_type::RIGHT_BRACE) && !is_at_end())
         statements.push_back(declaration());
@@ -209,16 +207,16 @@ auto Parser::block() -> std::vector<std::shared_ptr<Stmt>> {
 }
 
 
-auto Parser::assignment() -> std::shared_ptr<Expr> {
+auto Parser::assignment() -> Expr* {
     auto expr = or_expression();
 
     if(match(token_type::EQUAL)) {
         auto equals = previous();
         auto value = assignment();
 
-        if(auto* e = dynamic_cast<Variable*>(expr.get())) {
+        if(auto* e = dynamic_cast<Variable*>(expr)) {
             auto name = e->name;
-            return std::make_shared<Assign>(std::move(name), value);
+            return make<Assign>(std::move(name), value);
         }
 
         error(equals, "Invalid assignment target.");
@@ -227,43 +225,43 @@ auto Parser::assignment() -> std::shared_ptr<Expr> {
     return expr;
 }
 
-auto Parser::equality() -> std::shared_ptr<Expr> {
+auto Parser::equality() -> Expr* {
     auto expr = comparison();
 
     while(match(token_type::BANG_EQUAL, token_type::EQUAL_EQUAL)) {
         auto op = previous();
         auto right = comparison();
-        expr = std::make_shared<Binary>(expr, std::move(op), right);
+        expr = make<Binary>(expr, std::move(op), right);
     }
 
     return expr;
 }
 
-auto Parser::comparison() -> std::shared_ptr<Expr> {
+auto Parser::comparison() -> Expr* {
     auto expr = term();
 
     while(match(token_type::GREATER, token_type::GREATER_EQUAL, token_type::LESS, token_type::LESS_EQUAL)) {
         auto op = previous();
         auto right = term();
-        expr = std::make_shared<Binary>(expr, std::move(op), right);
+        expr = make<Binary>(expr, std::move(op), right);
     }
 
     return expr;
 }
 
-auto Parser::term() -> std::shared_ptr<Expr> {
+auto Parser::term() -> Expr* {
     auto expr = factor();
 
     while(match(token_type::MINUS, token_type::PLUS)) {
         auto op = previous();
         auto right = factor();
-        expr = std::make_shared<Binary>(expr, std::move(op), right);
+        expr = make<Binary>(expr, std::move(op), right);
     }
 
     return expr;
 }
 
-auto Parser::factor() -> std::shared_ptr<Expr> {
+auto Parser::factor() -> Expr* {
     auto expr = unary();
 
     while(match(token_type::SLASH,
@@ -276,37 +274,42 @@ auto Parser::factor() -> std::shared_ptr<Expr> {
                 token_type::RIGHT_SHIFT)) {
         Token op = previous();
         auto right = unary();
-        expr = std::make_shared<Binary>(expr, std::move(op), right);
+        expr = make<Binary>(expr, std::move(op), right);
     }
 
     return expr;
 }
 
-auto Parser::unary() -> std::shared_ptr<Expr> {
+auto Parser::unary() -> Expr* {
     if(match(token_type::BANG, token_type::MINUS, token_type::NOT)) {
         auto op = previous();
         auto right = unary();
-        return std::make_shared<Unary>(std::move(op), right);
+        return make<Unary>(std::move(op), right);
     }
 
     return call();
 }
 
-auto Parser::primary() -> std::shared_ptr<Expr>  {
-    if(match(token_type::FALSE)) return std::make_shared<Literal>(false);
-    if(match(token_type::TRUE)) return std::make_shared<Literal>(true);
-    if(match(token_type::NIL)) return std::make_shared<Literal>(nullptr);
+auto Parser::primary() -> Expr*  {
+    if(match(token_type::FALSE)) return make<Literal>(false);
+    if(match(token_type::TRUE)) return make<Literal>(true);
+    if(match(token_type::NIL)) return make<Literal>(nullptr);
 
-    if(match(token_type::NUMBER, token_type::STRING))
-        return std::make_shared<Literal>(previous().literal);
+    if(match(token_type::NUMBER)) {
+        const auto& literal = previous().literal;
+        if(std::holds_alternative<int64_t>(literal)) return make<Literal>(std::get<int64_t>(literal));
+        return make<Literal>(std::get<double>(literal));
+    }
+    if(match(token_type::STRING))
+        return make<Literal>(Interner::intern(std::get<std::string_view>(previous().literal)));
 
     if(match(token_type::IDENTIFIER))
-        return std::make_shared<Variable>(previous());
+        return make<Variable>(previous());
 
     if(match(token_type::LEFT_PAREN)) {
-        std::shared_ptr<Expr> expr = expression();
+        Expr* expr = expression();
         consume(token_type::RIGHT_PAREN, "Expect ')' after expression.");
-        return std::make_shared<Grouping>(expr);
+        return make<Grouping>(expr);
     }
 
     throw error(peek(), "Expect expression.");
@@ -324,7 +327,7 @@ auto Parser::match(T... type) -> bool {
     return false;
 }
 
-Token Parser::consume(token_type type, std::string msg) {
+const Token& Parser::consume(token_type type, std::string msg) {
     if(check(type)) return advance();
 
     throw error(peek(), msg);
@@ -337,7 +340,7 @@ auto Parser::check(token_type type) -> bool {
 }
 
 
-auto Parser::advance() -> Token {
+auto Parser::advance() -> const Token& {
     if(!is_at_end()) ++current;
 
     return previous();
@@ -347,11 +350,11 @@ auto Parser::is_at_end() -> bool{
     return peek().type == token_type::MINT_EOF;
 }
 
-auto Parser::peek() -> Token {
+auto Parser::peek() -> const Token& {
     return tokens.at(current);
 }
 
-auto Parser::previous() -> Token {
+auto Parser::previous() -> const Token& {
     return tokens.at(current - 1);
 }
 
@@ -5,57 +5,63 @@
  *
  */
 #pragma once 
-#include <memory>
+#include <utility>
 #include <vector>
 #include <stdexcept>
 #include "Token.h"
 #include "Expr.h"
 #include "Stmt.h"
+#include "Program.h"
 
 class Parser {
 public:
     explicit Parser(const std::vector<Token>& tokens) : tokens(tokens) {};
-    auto parse() -> std::vector<std::shared_ptr<Stmt>>;
+    auto parse() -> Program;
 private:
     class ParseError : public std::runtime_error {
     public:
       using std::runtime_error::runtime_error;
     };
 
-    auto expression() -> std::shared_ptr<Expr>;
-    auto declaration() -> std::shared_ptr<Stmt>;
-    auto statement() -> std::shared_ptr<Stmt>;
-    auto print_statement() -> std::shared_ptr<Stmt>;
-    auto var_declaration() -> std::shared_ptr<Stmt>;
-    auto while_statement() -> std::shared_ptr<Stmt>;
-    auto for_statement() -> std::shared_ptr<Stmt>;
-    auto function(std::string kind) -> std::shared_ptr<Function>;
-    auto return_statement() -> std::shared_ptr<Stmt>;
-    auto call() -> std::shared_ptr<Expr>;
-    auto finish_call(const std::shared_ptr<Expr>& callee) -> std::shared_ptr<Expr>;
-    auto and_expression() -> std::shared_ptr<Expr>;
-    auto or_expression() -> std::shared_ptr<Expr>;
-    auto expression_statement() -> std::shared_ptr<Stmt>;
-    auto if_statement() -> std::shared_ptr<Stmt>;
-    auto block() -> std::vector<std::shared_ptr<Stmt>>;
-    auto assignment() -> std::shared_ptr<Expr>;
-    auto equality() -> std::shared_ptr<Expr>;
-    auto comparison() -> std::shared_ptr<Expr>;
-    auto term() -> std::shared_ptr<Expr>;
-    auto factor() -> std::shared_ptr<Expr>;
-    auto unary() -> std::shared_ptr<Expr>;
-    auto primary() -> std::shared_ptr<Expr>;
+    auto expression() -> Expr*;
+    auto declaration() -> Stmt*;
+    auto statement() -> Stmt*;
+    auto print_statement() -> Stmt*;
+    auto var_declaration() -> Stmt*;
+    auto while_statement() -> Stmt*;
+    auto for_statement() -> Stmt*;
+    auto function(std::string kind) -> Function*;
+    auto return_statement() -> Stmt*;
+    auto call() -> Expr*;
+    auto finish_call(Expr* callee) -> Expr*;
+    auto and_expression() -> Expr*;
+    auto or_expression() -> Expr*;
+    auto expression_statement() -> Stmt*;
+    auto if_statement() -> Stmt*;
+    auto block() -> std::vector<Stmt*>;
+    auto assignment() -> Expr*;
+    auto equality() -> Expr*;
+    auto comparison() -> Expr*;
+    auto term() -> Expr*;
+    auto factor() -> Expr*;
+    auto unary() -> Expr*;
+    auto primary() -> Expr*;
     template <class... T>
     auto match(T... type) -> bool;
     auto check(token_type type) -> bool;
     auto is_at_end() -> bool;
-    auto peek() -> Token;
-    auto previous() -> Token;
+    auto peek() -> const Token&;
+    auto previous() -> const Token&;
     static auto error(const Token& token, const std::string& msg) -> ParseError;
-    auto advance() -> Token;
-    auto consume(token_type type, std::string msg) -> Token;
+    auto advance() -> const Token&;
+    auto consume(token_type type, std::string msg) -> const Token&;
     auto synchronize() -> void;
+    template<class T, class... Args>
+    auto make(Args&&... args) -> T* {
+        return program.arena.make<T>(std::forward<Args>(args)...);
+    }
 
     const std::vector<Token>& tokens;
     unsigned int current = 0;
+    Program program;
 };
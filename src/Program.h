@@ -0,0 +1,25 @@
+/*
+ * Mint interpreter
+ * Developed by Marco Cetica (c) 2022
+ * Released under GPLv3
+ *
+ */
+#pragma once
+#include <memory>
+#include <vector>
+#include "Arena.h"
+#include "Source.h"
+#include "Stmt.h"
+
+/*
+ * A parsed program. Every node of the syntax tree lives in the program
+ * arena and is freed together with it. Runtime objects(i.e., functions)
+ * point into the tree, so a program must outlive the engine state created
+ * by running it. Tokens in the tree are views into the source text, which
+ * the program owns as well.
+ */
+struct Program {
+    std::unique_ptr<const Source> source;
+    Arena arena;
+    std::vector<Stmt*> statements;
+};
@@ -1,184 +1,302 @@
+#include <algorithm>
+#include <utility>
 #include "Resolver.h"
 #include "Mint.h"
+#include "Natives.h"
 
 #define UNUSED(x) (void)(x)
 
-auto Resolver::resolve(const std::vector<std::shared_ptr<Stmt>> &statements) -> void {
+auto Resolver::resolve(const std::vector<Stmt*> &statements) -> void {
+    auto program = !std::exchange(resolving, true);
     for(auto& stmt : statements) resolve(stmt);
+
+    // Purity depends on the callees, which can be declared later on
+    if(program) {
+        classify_functions();
+        resolving = false;
+    }
 }
 
-auto Resolver::resolve(const std::shared_ptr<Stmt>& stmt) -> void {
+auto Resolver::resolve(Stmt* stmt) -> void {
     stmt->accept(*this);
 }
 
-auto Resolver::resolve(const std::shared_ptr<Expr>& expr) -> void {
+auto Resolver::resolve(Expr* expr) -> void {
     expr->accept(*this);
 }
 
-auto Resolver::resolve_function(const std::shared_ptr<Function>& function, function_type type) -> void {
+auto Resolver::resolve_function(Function* function, function_type type) -> void {
     function_type enclosing_fun = current_fun;
     current_fun = type;
+    // Without nested functions nothing can capture the locals of the
+    // function, so they do not need to outlive the call
+    auto framed = frames && !declares_function(function->body);
+    auto enclosing_frame = std::exchange(framed_fun, framed ? function : nullptr);
+    function->framed = framed;
 
-    begin_scope();
+    current_effects.push_back(functions.size());
+    functions.push_back(Effects{function, scopes.size(), false, {}});
+
+    begin_scope(framed);
     for(const auto& par : function->params) {
         declare(par);
         define(par);
     }
     resolve(function->body);
     end_scope();
+    current_effects.pop_back();
+    framed_fun = enclosing_frame;
     current_fun = enclosing_fun;
 }
 
-auto Resolver::begin_scope() -> void {
-    scopes.emplace_back();
+auto Resolver::is_non_local(int scope) const -> bool {
+    return !current_effects.empty() && scope < static_cast<int>(functions[current_effects.back()].scope);
+}
+
+auto Resolver::make_impure() -> void {
+    if(!current_effects.empty()) functions[current_effects.back()].impure = true;
+}
+
+auto Resolver::classify_functions() -> void {
+    // Assume every function without effects of its own is pure, then drop
+    // those calling anything else until nothing changes. Recursive calls
+    // among pure functions keep them pure
+    for(const auto& effects : functions) effects.function->pure = !effects.impure;
+
+    for(const auto& [name, bindings] : global_bindings)
+        if(Natives::find(name) != nullptr) rebound_natives.insert(name);
+
+    auto is_pure_global = [this](Symbol name) {
+        auto function = global_functions.find(name);
+        if(function == global_functions.end()) {
+            auto native = Natives::find(name);
+            return native != nullptr && native->pure && rebound_natives.count(name) == 0;
+        }
+        return global_bindings[name] == 1 && function->second->pure;
+    };
+
+    auto changed = true;
+    while(changed) {
+        changed = false;
+        for(const auto& effects : functions) {
+            if(!effects.function->pure || std::all_of(effects.callees.begin(), effects.callees.end(), is_pure_global))
+                continue;
+
+            effects.function->pure = false;
+            changed = true;
+        }
+    }
+
+    functions.clear();
+    global_functions.clear();
+    global_bindings.clear();
+}
+
+auto Resolver::declares_function(const std::vector<Stmt*>& statements) -> bool {
+    return std::any_of(statements.begin(), statements.end(), [](Stmt* statement) {
+        if(dynamic_cast<Function*>(statement) != nullptr) return true;
+        if(auto block = dynamic_cast<Block*>(statement)) return declares_function(block->statements);
+        if(auto loop = dynamic_cast<While*>(statement)) return declares_function({loop->body});
+        if(auto branch = dynamic_cast<If*>(statement))
+            return declares_function({branch->then_branch}) ||
+                   (branch->else_branch != nullptr && declares_function({branch->else_branch}));
+
+        return false;
+    });
+}
+
+auto Resolver::begin_scope(bool frame) -> void {
+    scopes.push_back(Scope{{}, frame});
 }
 
 auto Resolver::end_scope() -> void {
     scopes.pop_back();
 }
 
-auto Resolver::declare(const Token &name) -> void {
+auto Resolver::declare(const Token &name, Var* declaration) -> void {
     if(scopes.empty()) return;
 
     auto& scope = scopes.back();
-    if(scope.find(name.lexeme) != scope.end())
+    if(scope.locals.find(name.symbol) != scope.locals.end())
         Mint::error(name, "Already a variable with this name in this scope.");
 
-    scope[name.lexeme] = false;
+    // Slots are handed out in declaration order, per environment or
+    // per stack frame
+    auto slot = scope.frame ? framed_fun->frame_size++ : static_cast<unsigned int>(scope.locals.size());
+    if(scope.frame && declaration != nullptr) declaration->frame_slot = slot;
+    scope.locals.insert({name.symbol, Local{false, slot, declaration}});
 }
 
 auto Resolver::define(const Token &name) -> void {
     if(scopes.empty()) return;
-    scopes.back()[name.lexeme] = true;
+    scopes.back().locals[name.symbol].defined = true;
 }
 
-auto Resolver::resolve_local(const std::shared_ptr<Expr>& expr, const Token &name) -> void {
+auto Resolver::resolve_local(Resolution& resolved, const Token &name) -> int {
+    // Scopes in stack frames have no environment to skip
+    auto depth = 0;
     for(auto i = (signed)scopes.size()-1; i >= 0; i--) {
-        if(scopes[i].find(name.lexeme) != scopes[i].end()) {
-            interpreter.resolve(expr, (signed)(scopes.size() - 1 - i));
-            return;
+        auto elem = scopes[i].locals.find(name.symbol);
+        if(elem != scopes[i].locals.end()) {
+            resolved.depth = scopes[i].frame ? 0 : depth;
+            resolved.frame = scopes[i].frame;
+            resolved.slot = elem->second.slot;
+            resolved.declaration = elem->second.declaration;
+            return i;
         }
+        if(!scopes[i].frame) depth++;
     }
+
+    return -1;
 }
 
-std::any Resolver::visit_block_stmt(std::shared_ptr<Block> stmt) {
+void Resolver::visit_block_stmt(Block& stmt) {
+    // Blocks of framed functions declare into the frame
+    if(framed_fun != nullptr) {
+        stmt.scoped = false;
+        begin_scope(true);
+        resolve(stmt.statements);
+        end_scope();
+        return;
+    }
+
+    stmt.scoped = std::any_of(stmt.statements.begin(), stmt.statements.end(), [](Stmt* statement) {
+        return dynamic_cast<Var*>(statement) != nullptr || dynamic_cast<Function*>(statement) != nullptr;
+    });
+
+    if(!stmt.scoped) {
+        resolve(stmt.statements);
+        return;
+    }
+
     begin_scope();
-    resolve(stmt->statements);
+    resolve(stmt.statements);
     end_scope();
-
-    return {};
 }
 
-std::any Resolver::visit_expression_stmt(std::shared_ptr<Expression> stmt) {
-    resolve(stmt->expression);
-
-    return {};
+void Resolver::visit_expression_stmt(Expression& stmt) {
+    resolve(stmt.expression);
 }
 
-std::any Resolver::visit_function_stmt(std::shared_ptr<Function> stmt) {
-    declare(stmt->name);
-    define(stmt->name);
+void Resolver::visit_function_stmt(Function& stmt) {
+    // Nested functions can outlive the call and share its state
+    make_impure();
+    if(scopes.empty()) {
+        global_functions[stmt.name.symbol] = &stmt;
+        global_bindings[stmt.name.symbol]++;
+    }
 
-    resolve_function(stmt, function_type::FUNCTION);
+    declare(stmt.name);
+    define(stmt.name);
 
-    return {};
+    resolve_function(&stmt, function_type::FUNCTION);
 }
 
-std::any Resolver::visit_if_stmt(std::shared_ptr<If> stmt) {
-    resolve(stmt->condition);
-    resolve(stmt->then_branch);
+void Resolver::visit_if_stmt(If& stmt) {
+    resolve(stmt.condition);
+    resolve(stmt.then_branch);
 
-    if(stmt->else_branch != nullptr) resolve(stmt->else_branch);
-
-    return {};
+    if(stmt.else_branch != nullptr) resolve(stmt.else_branch);
 }
 
-std::any Resolver::visit_print_stmt(std::shared_ptr<Print> stmt) {
-    resolve(stmt->expression);
-
-    return {};
+void Resolver::visit_print_stmt(Print& stmt) {
+    make_impure();
+    resolve(stmt.expression);
 }
 
-std::any Resolver::visit_return_stmt(std::shared_ptr<Return> stmt) {
+void Resolver::visit_return_stmt(Return& stmt) {
     if(current_fun == function_type::NONE)
-        Mint::error(stmt->keyword, "Can't return from top-level code.");
-
-    if(stmt->value != nullptr) resolve(stmt->value);
+        Mint::error(stmt.keyword, "Can't return from top-level code.");
 
-    return {};
+    if(stmt.value != nullptr) resolve(stmt.value);
+    stmt.tail = dynamic_cast<Call*>(stmt.value) != nullptr;
 }
 
-std::any Resolver::visit_variable_stmt(std::shared_ptr<Var> stmt) {
-    declare(stmt->name);
+void Resolver::visit_variable_stmt(Var& stmt) {
+    if(scopes.empty()) global_bindings[stmt.name.symbol]++;
+    declare(stmt.name, &stmt);
 
-    if(stmt->initializer != nullptr) resolve(stmt->initializer);
-    define(stmt->name);
-
-    return {};
+    if(stmt.initializer != nullptr) resolve(stmt.initializer);
+    define(stmt.name);
 }
 
-std::any Resolver::visit_while_stmt(std::shared_ptr<While> stmt) {
-    resolve(stmt->condition);
-    resolve(stmt->body);
-
-    return {};
+void Resolver::visit_while_stmt(While& stmt) {
+    resolve(stmt.condition);
+    resolve(stmt.body);
 }
 
-std::any Resolver::visit_assign_expr(std::shared_ptr<Assign> expr) {
-    resolve(expr->value);
-    resolve_local(expr, expr->name);
+Value Resolver::visit_assign_expr(Assign& expr) {
+    resolve(expr.value);
+    auto scope = resolve_local(expr.resolved, expr.name);
+    if(expr.resolved.declaration != nullptr) expr.resolved.declaration->reassigned = true;
+    if(expr.resolved.is_global()) global_bindings[expr.name.symbol]++;
+    if(is_non_local(scope)) make_impure();
 
     return {};
 }
 
-std::any Resolver::visit_binary_expr(std::shared_ptr<Binary> expr) {
-    resolve(expr->left);
-    resolve(expr->right);
+Value Resolver::visit_binary_expr(Binary& expr) {
+    resolve(expr.left);
+    resolve(expr.right);
 
     return {};
 }
 
-std::any Resolver::visit_call_expr(std::shared_ptr<Call> expr) {
-    resolve(expr->callee);
+Value Resolver::visit_call_expr(Call& expr) {
+    // Only calls to global functions can be pure, once every function
+    // has been seen
+    auto callee = dynamic_cast<Variable*>(expr.callee);
+    if(callee == nullptr) {
+        resolve(expr.callee);
+        make_impure();
+    } else if(resolve_variable(*callee) >= 0) {
+        make_impure();
+    } else if(!current_effects.empty()) {
+        functions[current_effects.back()].callees.push_back(callee->name.symbol);
+    }
 
-    for(const auto& arg : expr->arguments) resolve(arg);
+    for(const auto& arg : expr.arguments) resolve(arg);
 
     return {};
 }
 
-std::any Resolver::visit_grouping_expr(std::shared_ptr<Grouping> expr) {
-    resolve(expr->expr);
+Value Resolver::visit_grouping_expr(Grouping& expr) {
+    resolve(expr.expr);
 
     return {};
 }
 
-std::any Resolver::visit_literal_expr(std::shared_ptr<Literal> expr) {
+Value Resolver::visit_literal_expr(Literal& expr) {
     UNUSED(expr);
     return {};
 }
 
-std::any Resolver::visit_logical_expr(std::shared_ptr<Logical> expr) {
-    resolve(expr->left);
-    resolve(expr->right);
+Value Resolver::visit_logical_expr(Logical& expr) {
+    resolve(expr.left);
+    resolve(expr.right);
 
     return {};
 }
 
-std::any Resolver::visit_unary_expr(std::shared_ptr<Unary> expr) {
-    resolve(expr->right);
+Value Resolver::visit_unary_expr(Unary& expr) {
+    resolve(expr.right);
 
     return {};
 }
 
-std::any Resolver::visit_variable_expr(std::shared_ptr<Variable> expr) {
+Value Resolver::visit_variable_expr(Variable& expr) {
+    if(is_non_local(resolve_variable(expr))) make_impure();
+
+    return {};
+}
+
+auto Resolver::resolve_variable(Variable& expr) -> int {
     if(!scopes.empty()) {
-        auto& scope = scopes.back();
-        auto elem = scope.find(expr->name.lexeme);
-        if(elem != scope.end() && !elem->second)
-            Mint::error(expr->name, "Can't read local variable in its own initializer.");
+        auto& scope = scopes.back().locals;
+        auto elem = scope.find(expr.name.symbol);
+        if(elem != scope.end() && !elem->second.defined)
+            Mint::error(expr.name, "Can't read local variable in its own initializer.");
     }
 
-    resolve_local(expr, expr->name);
-
-    return {};
+    return resolve_local(expr.resolved, expr.name);
 }
\ No newline at end of file
@@ -5,48 +5,89 @@
  *
  */
 #pragma once
+#include <unordered_map>
+#include <unordered_set>
 #include "Stmt.h"
-#include "Interpreter.h"
 
 class Resolver : public ExprVisitor, public StmtVisitor {
 public:
-    explicit Resolver(Interpreter& interpreter) : interpreter(interpreter) {};
-    void resolve(const std::vector<std::shared_ptr<Stmt>>& statements);
+    // With 'frames', functions that declare no nested function keep their
+    // locals in the stack frame of the call instead of in environments
+    explicit Resolver(bool frames = false) : frames(frames) {};
+    void resolve(const std::vector<Stmt*>& statements);
     // Stmt abstract class
-    std::any visit_block_stmt(std::shared_ptr<Block> stmt) override;
-    std::any visit_expression_stmt(std::shared_ptr<Expression> stmt) override;
-    std::any visit_function_stmt(std::shared_ptr<Function> stmt) override;
-    std::any visit_if_stmt(std::shared_ptr<If> stmt) override;
-    std::any visit_print_stmt(std::shared_ptr<Print> stmt) override;
-    std::any visit_return_stmt(std::shared_ptr<Return> stmt) override;
-    std::any visit_variable_stmt(std::shared_ptr<Var> stmt) override;
-    std::any visit_while_stmt(std::shared_ptr<While> stmt) override;
+    void visit_block_stmt(Block& stmt) override;
+    void visit_expression_stmt(Expression& stmt) override;
+    void visit_function_stmt(Function& stmt) override;
+    void visit_if_stmt(If& stmt) override;
+    void visit_print_stmt(Print& stmt) override;
+    void visit_return_stmt(Return& stmt) override;
+    void visit_variable_stmt(Var& stmt) override;
+    void visit_while_stmt(While& stmt) override;
     // Expr abstract class
-    std::any visit_assign_expr(std::shared_ptr<Assign> expr) override;
-    std::any visit_binary_expr(std::shared_ptr<Binary> expr) override;
-    std::any visit_call_expr(std::shared_ptr<Call> expr) override;
-    std::any visit_grouping_expr(std::shared_ptr<Grouping> expr) override;
-    std::any visit_literal_expr(std::shared_ptr<Literal> expr) override;
-    std::any visit_logical_expr(std::shared_ptr<Logical> expr) override;
-    std::any visit_unary_expr(std::shared_ptr<Unary> expr) override;
-    std::any visit_variable_expr(std::shared_ptr<Variable> expr) override;
+    Value visit_assign_expr(Assign& expr) override;
+    Value visit_binary_expr(Binary& expr) override;
+    Value visit_call_expr(Call& expr) override;
+    Value visit_grouping_expr(Grouping& expr) override;
+    Value visit_literal_expr(Literal& expr) override;
+    Value visit_logical_expr(Logical& expr) override;
+    Value visit_unary_expr(Unary& expr) override;
+    Value visit_variable_expr(Variable& expr) override;
 
 private:
     enum class function_type {
         NONE,
         FUNCTION
     };
-    auto resolve(const std::shared_ptr<Stmt>& stmt) -> void;
-    auto resolve(const std::shared_ptr<Expr>& expr) -> void;
-    auto resolve_function(const std::shared_ptr<Function>& function, function_type type) -> void;
-    auto begin_scope() -> void;
+    struct Local {
+        bool defined;
+        unsigned int slot;
+        Var* declaration;
+    };
+    struct Scope {
+        std::unordered_map<Symbol, Local> locals;
+        // Whether the scope lives in the stack frame of a function
+        bool frame;
+    };
+    // What a function does besides computing its result from its arguments
+    struct Effects {
+        Function* function;
+        // Index of the outermost scope of the function
+        size_t scope;
+        // Set on output, nested functions and any access to non-local
+        // variables other than calls to global functions
+        bool impure;
+        std::vector<Symbol> callees;
+    };
+    auto resolve(Stmt* stmt) -> void;
+    auto resolve(Expr* expr) -> void;
+    auto resolve_function(Function* function, function_type type) -> void;
+    auto begin_scope(bool frame = false) -> void;
     auto end_scope() -> void;
-    auto declare(const Token& name) -> void;
+    auto declare(const Token& name, Var* declaration = nullptr) -> void;
     auto define(const Token& name) -> void;
-    auto resolve_local(const std::shared_ptr<Expr>& expr, const Token& name) -> void;
+    // Returns the index of the scope declaring the name, or -1 for globals
+    auto resolve_local(Resolution& resolved, const Token& name) -> int;
+    auto resolve_variable(Variable& expr) -> int;
+    auto is_non_local(int scope) const -> bool;
+    auto make_impure() -> void;
+    auto classify_functions() -> void;
+    static auto declares_function(const std::vector<Stmt*>& statements) -> bool;
 
-    Interpreter& interpreter;
-    std::vector<std::map<std::string, bool>> scopes;
+    std::vector<Scope> scopes;
     function_type current_fun = function_type::NONE;
+    const bool frames;
+    // Function whose stack frame receives the locals being declared
+    Function* framed_fun = nullptr;
+    bool resolving = false;
+    // Purity analysis: every function of the program, the ones being
+    // resolved(innermost last), and the global names bound by function
+    // declarations with the number of times each global is bound
+    std::vector<Effects> functions;
+    std::vector<size_t> current_effects;
+    std::unordered_map<Symbol, Function*> global_functions;
+    std::unordered_map<Symbol, unsigned int> global_bindings;
+    // Natives rebound by any program so far, calls to them are no longer pure
+    static inline std::unordered_set<Symbol> rebound_natives;
 };
 
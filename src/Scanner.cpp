@@ -0,0 +1,158 @@
+#include <cstdint>
+#include <cstring>
+#include "Scanner.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MINT_SIMD
+#endif
+
+namespace {
+constexpr auto is_blank(char c) -> bool {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+constexpr auto is_identifier(char c) -> bool {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+// Scalar loops, used for the tail of the input and on other architectures
+auto blanks_tail(const char* p, const char* end, unsigned int& line) -> const char* {
+    for(; p < end && is_blank(*p); p++)
+        if(*p == '\n') line++;
+
+    return p;
+}
+
+auto identifier_tail(const char* p, const char* end) -> const char* {
+    while(p < end && is_identifier(*p)) p++;
+
+    return p;
+}
+
+auto quote_tail(const char* p, const char* end, unsigned int& line) -> const char* {
+    for(; p < end && *p != '"'; p++)
+        if(*p == '\n') line++;
+
+    return p;
+}
+
+// Bytes before the first set bit of 'stop'(or every byte when no bit is set)
+inline auto below(uint32_t stop) -> uint32_t {
+    return stop == 0 ? ~0u : (stop & -stop) - 1;
+}
+
+struct Kernels {
+    const char* (*skip_blanks)(const char*, const char*, unsigned int&);
+    const char* (*skip_identifier)(const char*, const char*);
+    const char* (*find_quote)(const char*, const char*, unsigned int&);
+    const char* isa;
+};
+
+#ifdef MINT_SIMD
+/*
+ * Both instruction sets share the same kernels: 'V' wraps the load,
+ * compare and movemask intrinsics of one vector width. Signed compares are
+ * fine for ranges of ASCII characters, since bytes >= 0x80 are negative.
+ */
+#define MINT_KERNELS(V, TARGET)                                                                         \
+TARGET auto V##_skip_blanks(const char* p, const char* end, unsigned int& line) -> const char* {       \
+    for(; p + V::width <= end; p += V::width) {                                                        \
+        auto block = V::load(p);                                                                        \
+        auto newlines = V::mask(V::eq(block, '\n'));                                                    \
+        auto blanks = newlines | V::mask(V::eq(block, ' ')) | V::mask(V::eq(block, '\t'))               \
+                    | V::mask(V::eq(block, '\r'));                                                      \
+        auto stop = ~blanks & V::full;                                                                  \
+        line += __builtin_popcount(newlines & below(stop));                                             \
+        if(stop != 0) return p + __builtin_ctz(stop);                                                   \
+    }                                                                                                   \
+    return blanks_tail(p, end, line);                                                                   \
+}                                                                                                       \
+TARGET auto V##_skip_identifier(const char* p, const char* end) -> const char* {                       \
+    for(; p + V::width <= end; p += V::width) {                                                        \
+        auto block = V::load(p);                                                                        \
+        auto letters = V::in_range(V::lower(block), 'a', 'z');                                          \
+        auto valid = V::mask(letters) | V::mask(V::in_range(block, '0', '9')) | V::mask(V::eq(block, '_'));\
+        auto stop = ~valid & V::full;                                                                   \
+        if(stop != 0) return p + __builtin_ctz(stop);                                                   \
+    }                                                                                                   \
+    return identifier_tail(p, end);                                                                     \
+}                                                                                                       \
+TARGET auto V##_find_quote(const char* p, const char* end, unsigned int& line) -> const char* {        \
+    for(; p + V::width <= end; p += V::width) {                                                        \
+        auto block = V::load(p);                                                                        \
+        auto stop = V::mask(V::eq(block, '"'));                                                         \
+        line += __builtin_popcount(V::mask(V::eq(block, '\n')) & below(stop));                          \
+        if(stop != 0) return p + __builtin_ctz(stop);                                                   \
+    }                                                                                                   \
+    return quote_tail(p, end, line);                                                                    \
+}
+
+struct sse2 {
+    static constexpr int width = 16;
+    static constexpr uint32_t full = 0xFFFF;
+    static auto load(const char* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    static auto eq(__m128i v, char c) { return _mm_cmpeq_epi8(v, _mm_set1_epi8(c)); }
+    static auto lower(__m128i v) { return _mm_or_si128(v, _mm_set1_epi8(0x20)); }
+    static auto in_range(__m128i v, char lo, char hi) {
+        return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(static_cast<char>(lo - 1))),
+                             _mm_cmplt_epi8(v, _mm_set1_epi8(static_cast<char>(hi + 1))));
+    }
+    static auto mask(__m128i v) -> uint32_t { return static_cast<uint32_t>(_mm_movemask_epi8(v)); }
+};
+
+#define MINT_AVX2 __attribute__((target("avx2")))
+struct avx2 {
+    static constexpr int width = 32;
+    static constexpr uint32_t full = 0xFFFFFFFF;
+    MINT_AVX2 static auto load(const char* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    MINT_AVX2 static auto eq(__m256i v, char c) { return _mm256_cmpeq_epi8(v, _mm256_set1_epi8(c)); }
+    MINT_AVX2 static auto lower(__m256i v) { return _mm256_or_si256(v, _mm256_set1_epi8(0x20)); }
+    MINT_AVX2 static auto in_range(__m256i v, char lo, char hi) {
+        return _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(static_cast<char>(lo - 1))),
+                                _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(hi + 1)), v));
+    }
+    MINT_AVX2 static auto mask(__m256i v) -> uint32_t { return static_cast<uint32_t>(_mm256_movemask_epi8(v)); }
+};
+
+MINT_KERNELS(sse2, )
+MINT_KERNELS(avx2, MINT_AVX2)
+#endif
+
+auto select_kernels() -> Kernels {
+#ifdef MINT_SIMD
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2"))
+        return {avx2_skip_blanks, avx2_skip_identifier, avx2_find_quote, "avx2"};
+
+    return {sse2_skip_blanks, sse2_skip_identifier, sse2_find_quote, "sse2"};
+#else
+    return {blanks_tail, identifier_tail, quote_tail, "scalar"};
+#endif
+}
+
+const Kernels kernels = select_kernels();
+}
+
+auto Scanner::skip_blanks(const char* begin, const char* end, unsigned int& line) -> const char* {
+    return kernels.skip_blanks(begin, end, line);
+}
+
+auto Scanner::skip_identifier(const char* begin, const char* end) -> const char* {
+    return kernels.skip_identifier(begin, end);
+}
+
+auto Scanner::find_quote(const char* begin, const char* end, unsigned int& line) -> const char* {
+    return kernels.find_quote(begin, end, line);
+}
+
+auto Scanner::find_newline(const char* begin, const char* end) -> const char* {
+    // memchr is already vectorised by the C library
+    auto newline = std::memchr(begin, '\n', static_cast<size_t>(end - begin));
+
+    return newline != nullptr ? static_cast<const char*>(newline) : end;
+}
+
+auto Scanner::isa() -> const char* {
+    return kernels.isa;
+}
@@ -0,0 +1,27 @@
+/*
+ * Mint interpreter
+ * Developed by Marco Cetica (c) 2022
+ * Released under GPLv3
+ *
+ */
+#pragma once
+
+/*
+ * Character scanning kernels used by the lexer. Each kernel looks for the
+ * end of a run of characters of the same class, 16(SSE2) or 32(AVX2) bytes
+ * at a time; the widest instruction set supported by the CPU is picked at
+ * startup. Every kernel returns 'end' when the run reaches the end of input.
+ */
+class Scanner {
+public:
+    // First character that is not a blank, counting the newlines skipped
+    static auto skip_blanks(const char* begin, const char* end, unsigned int& line) -> const char*;
+    // First character that cannot be part of an identifier
+    static auto skip_identifier(const char* begin, const char* end) -> const char*;
+    // Closing quote of a string literal, counting the newlines skipped
+    static auto find_quote(const char* begin, const char* end, unsigned int& line) -> const char*;
+    // End of the current line
+    static auto find_newline(const char* begin, const char* end) -> const char*;
+    // Name of the instruction set in use(i.e., for benchmarks)
+    static auto isa() -> const char*;
+};
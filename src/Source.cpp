@@ -0,0 +1,42 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Source.h"
+
+Source::Source(void* mapping, size_t size)
+    : mapping(mapping), view(static_cast<const char*>(mapping), size) {}
+
+Source::~Source() {
+    if(mapping != nullptr) munmap(mapping, view.size());
+}
+
+auto Source::from_file(const std::string& filepath) -> std::unique_ptr<Source> {
+    auto fd = open(filepath.c_str(), O_RDONLY);
+    if(fd < 0) return nullptr;
+
+    std::unique_ptr<Source> source;
+    struct stat info{};
+    if(fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        auto size = static_cast<size_t>(info.st_size);
+        auto mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(mapping != MAP_FAILED) {
+            // The lexer reads the script front to back exactly once
+            madvise(mapping, size, MADV_SEQUENTIAL);
+            source.reset(new Source(mapping, size));
+        }
+    }
+
+    // Pipes, devices and empty files cannot be mapped
+    if(source == nullptr) {
+        std::string text;
+        char chunk[64 * 1024];
+        ssize_t count;
+        while((count = read(fd, chunk, sizeof(chunk))) > 0)
+            text.append(chunk, static_cast<size_t>(count));
+        if(count == 0) source = std::make_unique<Source>(std::move(text));
+    }
+    close(fd);
+
+    return source;
+}
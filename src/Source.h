@@ -0,0 +1,36 @@
+/*
+ * Mint interpreter
+ * Developed by Marco Cetica (c) 2022
+ * Released under GPLv3
+ *
+ */
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+/*
+ * Text of a Mint script. Regular files are memory mapped and scanned in
+ * place, everything else(i.e., pipes or the REPL input) is kept in a
+ * string. Tokens are views into the text, so the source must outlive them.
+ */
+class Source {
+public:
+    explicit Source(std::string text) : buffer(std::move(text)), view(buffer) {};
+    Source(const Source&) = delete;
+    auto operator=(const Source&) -> Source& = delete;
+    ~Source();
+
+    // Returns null when the file cannot be opened or read
+    static auto from_file(const std::string& filepath) -> std::unique_ptr<Source>;
+
+    [[nodiscard]] auto text() const -> std::string_view { return view; }
+
+private:
+    Source(void* mapping, size_t size);
+
+    std::string buffer;
+    void* mapping = nullptr;
+    std::string_view view;
+};
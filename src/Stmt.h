@@ -5,8 +5,8 @@
  *
  */
 #pragma once
-#include <any>
 #include <memory>
+#include <optional>
 #include <utility>
 #include <vector>
 #include "Expr.h"
@@ -19,115 +19,141 @@ struct Print;
 struct Return;
 struct Var;
 struct While;
+struct CountedLoop;
+class Memo;
 
 class StmtVisitor {
 public:
-    virtual std::any visit_block_stmt(std::shared_ptr<Block> stmt) = 0;
-    virtual std::any visit_expression_stmt(std::shared_ptr<Expression> stmt) = 0;
-    virtual std::any visit_function_stmt(std::shared_ptr<Function> stmt) = 0;
-    virtual std::any visit_if_stmt(std::shared_ptr<If> stmt) = 0;
-    virtual std::any visit_print_stmt(std::shared_ptr<Print> stmt) = 0;
-    virtual std::any visit_return_stmt(std::shared_ptr<Return> stmt) = 0;
-    virtual std::any visit_variable_stmt(std::shared_ptr<Var> stmt) = 0;
-    virtual std::any visit_while_stmt(std::shared_ptr<While> stmt) = 0;
+    virtual void visit_block_stmt(Block& stmt) = 0;
+    virtual void visit_expression_stmt(Expression& stmt) = 0;
+    virtual void visit_function_stmt(Function& stmt) = 0;
+    virtual void visit_if_stmt(If& stmt) = 0;
+    virtual void visit_print_stmt(Print& stmt) = 0;
+    virtual void visit_return_stmt(Return& stmt) = 0;
+    virtual void visit_variable_stmt(Var& stmt) = 0;
+    virtual void visit_while_stmt(While& stmt) = 0;
     virtual ~StmtVisitor() = default;
 };
 
 class Stmt {
 public:
-    virtual std::any accept(StmtVisitor& visitor) = 0;
+    virtual void accept(StmtVisitor& visitor) = 0;
     virtual ~Stmt() = default;
 };
 
-struct Block : Stmt, public std::enable_shared_from_this<Block> {
-    explicit Block(std::vector<std::shared_ptr<Stmt>> statements) : statements(std::move(statements)) {};
+struct Block : Stmt {
+    explicit Block(std::vector<Stmt*> statements, bool scoped = true)
+        : statements(std::move(statements)), scoped(scoped) {};
 
-    std::any accept(StmtVisitor& visitor) override {
-        return visitor.visit_block_stmt(shared_from_this());
+    void accept(StmtVisitor& visitor) override {
+        visitor.visit_block_stmt(*this);
     }
 
-    const std::vector<std::shared_ptr<Stmt>> statements;
+    const std::vector<Stmt*> statements;
+    // Whether the block needs a scope of its own. The resolver clears it for
+    // blocks that declare nothing, which then run in the enclosing scope
+    bool scoped;
 };
 
-struct Expression : Stmt, public std::enable_shared_from_this<Expression> {
-    explicit Expression(std::shared_ptr<Expr> expression) : expression(std::move(expression)) {};
+struct Expression : Stmt {
+    explicit Expression(Expr* expression) : expression(expression) {};
 
-    std::any accept(StmtVisitor& visitor) override {
-        return visitor.visit_expression_stmt(shared_from_this());
+    void accept(StmtVisitor& visitor) override {
+        visitor.visit_expression_stmt(*this);
     }
 
-    const std::shared_ptr<Expr> expression;
+    Expr* const expression;
 };
 
-struct Function : Stmt, public std::enable_shared_from_this<Function> {
-    Function(Token name, std::vector<Token> params, std::vector<std::shared_ptr<Stmt>> body)
+struct Function : Stmt {
+    Function(Token name, std::vector<Token> params, std::vector<Stmt*> body)
         : name(std::move(name)), params(std::move(params)), body(std::move(body)) {};
 
-    std::any accept(StmtVisitor& visitor) override {
-        return visitor.visit_function_stmt(shared_from_this());
+    void accept(StmtVisitor& visitor) override {
+        visitor.visit_function_stmt(*this);
     }
 
     const Token name;
     const std::vector<Token> params;
-    const std::vector<std::shared_ptr<Stmt>> body;
+    const std::vector<Stmt*> body;
+    // Set by the resolver when the locals of the function live in the stack
+    // frame of the call, which then needs 'frame_size' slots(parameters first)
+    bool framed = false;
+    unsigned int frame_size = 0;
+    // Set by the resolver when the result depends only on the arguments and
+    // calling the function has no other effect
+    bool pure = false;
+    // Cached results of a pure function, created by its first memoised call
+    mutable std::shared_ptr<Memo> memo;
 };
 
-struct If : Stmt, public std::enable_shared_from_this<If> {
-    If(std::shared_ptr<Expr>  condition, std::shared_ptr<Stmt>  then_branch, std::shared_ptr<Stmt>  else_branch)
-        : condition(std::move(condition)), then_branch(std::move(then_branch)), else_branch(std::move(else_branch)) {};
+struct If : Stmt {
+    If(Expr* condition, Stmt* then_branch, Stmt* else_branch)
+        : condition(condition), then_branch(then_branch), else_branch(else_branch) {};
 
-    std::any accept(StmtVisitor& visitor) override {
-        return visitor.visit_if_stmt(shared_from_this());
+    void accept(StmtVisitor& visitor) override {
+        visitor.visit_if_stmt(*this);
     }
 
-    const std::shared_ptr<Expr> condition;
-    const std::shared_ptr<Stmt> then_branch;
-    const std::shared_ptr<Stmt> else_branch;
+    Expr* const condition;
+    Stmt* const then_branch;
+    Stmt* const else_branch;
 };
 
-struct Print : Stmt, public std::enable_shared_from_this<Print> {
-    explicit Print(std::shared_ptr<Expr> expression) : expression(std::move(expression)) {};
+struct Print : Stmt {
+    explicit Print(Expr* expression) : expression(expression) {};
 
-    std::any accept(StmtVisitor& visitor) override {
-        return visitor.visit_print_stmt(shared_from_this());
+    void accept(StmtVisitor& visitor) override {
+        visitor.visit_print_stmt(*this);
     }
 
-    const std::shared_ptr<Expr> expression;
+    Expr* const expression;
 };
 
-struct Return : Stmt, public std::enable_shared_from_this<Return> {
-    Return(Token keyword, std::shared_ptr<Expr> value)
-        : keyword(std::move(keyword)), value(std::move(value)) {};
+struct Return : Stmt {
+    Return(Token keyword, Expr* value)
+        : keyword(std::move(keyword)), value(value) {};
 
-    std::any accept(StmtVisitor& visitor) override {
-        return visitor.visit_return_stmt(shared_from_this());
+    void accept(StmtVisitor& visitor) override {
+        visitor.visit_return_stmt(*this);
     }
 
     const Token keyword;
-    const std::shared_ptr<Expr> value;
+    Expr* const value;
+    // Set by the resolver when the value is a call, which can then reuse
+    // the frame of the returning function
+    bool tail = false;
 };
 
-struct Var : Stmt, public std::enable_shared_from_this<Var> {
-    Var(Token name, std::shared_ptr<Expr> initializer)
-        : name(std::move(name)), initializer(std::move(initializer)) {};
+struct Var : Stmt {
+    Var(Token name, Expr* initializer)
+        : name(std::move(name)), initializer(initializer) {};
 
-    std::any accept(StmtVisitor& visitor) override {
-        return visitor.visit_variable_stmt(shared_from_this());
+    void accept(StmtVisitor& visitor) override {
+        visitor.visit_variable_stmt(*this);
     }
 
     const Token name;
-    const std::shared_ptr<Expr> initializer;
+    Expr* const initializer;
+    // Set by the resolver when the variable is assigned after its declaration
+    bool reassigned = false;
+    // Stack frame slot of locals of framed functions
+    std::optional<unsigned int> frame_slot;
 };
 
-struct While : Stmt, public std::enable_shared_from_this<While> {
-    While(std::shared_ptr<Expr> condition, std::shared_ptr<Stmt> body)
-        : condition(std::move(condition)), body(std::move(body)) {};
+struct While : Stmt {
+    While(Expr* condition, Stmt* body)
+        : condition(condition), body(body) {};
 
-    std::any accept(StmtVisitor& visitor) override {
-        return visitor.visit_while_stmt(shared_from_this());
+    void accept(StmtVisitor& visitor) override {
+        visitor.visit_while_stmt(*this);
     }
 
-    std::shared_ptr<Expr> condition;
-    std::shared_ptr<Stmt> body;
+    Expr* condition;
+    Stmt* body;
+    // Set the first time the tree interpreter runs the loop: its shape when
+    // it counts with a local(null otherwise)
+    bool matched = false;
+    std::shared_ptr<const CountedLoop> counted;
 };
 
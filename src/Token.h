@@ -5,9 +5,11 @@
  *
  */
 #pragma once
-#include <any>
+#include <cstdint>
 #include <string>
-#include <utility>
+#include <string_view>
+#include <variant>
+#include "Interner.h"
 
 enum class token_type {
     // Single character tokens(i.e., dots, parenthesis, etc.
@@ -26,14 +28,25 @@ enum class token_type {
 };
 
 
+// Value of literal tokens: the unquoted text of strings and the value of numbers
+using TokenLiteral = std::variant<std::monostate, std::string_view, double, int64_t>;
+
+/*
+ * Tokens do not own their text: the lexeme(and the literal of strings)
+ * is a view into the source buffer, which must outlive them.
+ */
 class Token {
 public:
-    Token(token_type type, std::string lexeme, std::any literal, unsigned int line)
-        : type(type), literal(std::move(literal)), lexeme(std::move(lexeme)), line(line) {};
+    Token(token_type type, std::string_view lexeme, TokenLiteral literal, unsigned int line)
+        : Token(type, lexeme, literal, line, type == token_type::IDENTIFIER ? Interner::symbol(lexeme) : nullptr) {};
+    Token(token_type type, std::string_view lexeme, TokenLiteral literal, unsigned int line, Symbol symbol)
+        : type(type), line(line), lexeme(lexeme), literal(literal), symbol(symbol) {};
     [[nodiscard]] auto to_string() -> std::string const;
 
     const token_type type;
-    const std::any literal;
-    const std::string lexeme;
     const unsigned int line;
+    const std::string_view lexeme;
+    const TokenLiteral literal;
+    // Interned name of identifiers, null for every other token
+    const Symbol symbol;
 };
\ No newline at end of file
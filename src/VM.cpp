@@ -0,0 +1,349 @@
+#include <cmath>
+#include <functional>
+#include <limits>
+#include "VM.h"
+#include "Compiler.h"
+#include "Natives.h"
+#include "Mint.h"
+#include "Operators.h"
+#include "Output.h"
+#include "RuntimeError.h"
+
+// Maximum call depth
+constexpr auto FRAMES_MAX = 4096U;
+// Size of the value stack
+constexpr auto STACK_MAX = FRAMES_MAX * 64U;
+
+VM::VM() : stack_top(nullptr) {
+    for(const auto& native : Natives::registry()) {
+        auto& global = globals[global_slot(Interner::symbol(native.as_object<MintNative>()->name))];
+        global.value = native;
+        global.defined = true;
+    }
+}
+
+auto VM::interpret(const std::vector<Stmt*>& statements) -> void {
+    Compiler compiler(*this);
+    auto script = compiler.compile(statements);
+    if(script.is_nil()) return;
+
+    // The stack is allocated lazily, the VM is not used by the default engine
+    if(stack.empty()) {
+        stack.resize(STACK_MAX);
+        frames.reserve(FRAMES_MAX);
+        stack_top = stack.data();
+    }
+
+    try {
+        // The script has no call site to report a stack overflow at
+        static const Token script_start(token_type::MINT_EOF, "", {}, 0);
+        if(!fits(*script.as_object<MintPrototype>(), stack_top)) throw RuntimeError(script_start, "Stack overflow.");
+        auto closure = new MintClosure(script.as_object<MintPrototype>());
+        *stack_top++ = Value(closure);
+        frames.push_back(CallFrame{closure, closure->prototype->chunk.code.data(), stack_top - 1});
+        run();
+    } catch(const RuntimeError& err) {
+        Mint::runtime_error(err);
+        reset_stack();
+    }
+}
+
+auto VM::global_slot(Symbol name) -> uint16_t {
+    auto elem = global_slots.find(name);
+    if(elem != global_slots.end()) return elem->second;
+
+    if(globals.size() > std::numeric_limits<uint16_t>::max()) {
+        Mint::error(0, "Too many global variables.");
+        return 0;
+    }
+
+    auto slot = static_cast<uint16_t>(globals.size());
+    globals.emplace_back();
+    global_slots.insert({name, slot});
+
+    return slot;
+}
+
+auto VM::reset_stack() -> void {
+    close_upvalues(stack.data());
+    while(stack_top > stack.data())
+        *--stack_top = Value();
+    frames.clear();
+}
+
+auto VM::call(const Value& callee, uint8_t arg_count, const Token& paren) -> void {
+    if(callee.is_native()) {
+        call_native(*callee.as_object<MintNative>(), arg_count, paren);
+        return;
+    }
+
+    if(!callee.is_object() || callee.as_object()->type != object_type::CLOSURE)
+        throw RuntimeError(paren, "Can only call functions and classes.");
+
+    auto closure = callee.as_object<MintClosure>();
+    auto arity = closure->prototype->arity;
+    if(arg_count != arity) {
+        throw RuntimeError(paren, "Expected " +
+            std::to_string(arity) + " arguments but got " +
+            std::to_string(arg_count) + ".");
+    }
+
+    auto slots = stack_top - arg_count - 1;
+    if(frames.size() == FRAMES_MAX || !fits(*closure->prototype, slots))
+        throw RuntimeError(paren, "Stack overflow.");
+
+    frames.push_back(CallFrame{closure, closure->prototype->chunk.code.data(), slots});
+}
+
+auto VM::fits(const MintPrototype& prototype, const Value* slots) const -> bool {
+    return static_cast<size_t>(stack.data() + stack.size() - slots) >= prototype.max_stack;
+}
+
+auto VM::call_native(const MintNative& native, uint8_t arg_count, const Token& paren) -> void {
+    if(arg_count != native.params) {
+        throw RuntimeError(paren, "Expected " +
+            std::to_string(native.params) + " arguments but got " +
+            std::to_string(arg_count) + ".");
+    }
+
+    // Natives read their arguments in place and need no frame
+    auto result = native.function(stack_top - arg_count);
+    for(auto i = 0U; i <= arg_count; i++)
+        *--stack_top = Value();
+    *stack_top++ = std::move(result);
+}
+
+auto VM::capture_upvalue(Value* local) -> Value {
+    auto it = open_upvalues.end();
+    while(it != open_upvalues.begin() && (it - 1)->as_object<MintUpvalue>()->location > local)
+        --it;
+
+    if(it != open_upvalues.begin() && (it - 1)->as_object<MintUpvalue>()->location == local)
+        return *(it - 1);
+
+    auto upvalue = Value(new MintUpvalue(local));
+    open_upvalues.insert(it, upvalue);
+
+    return upvalue;
+}
+
+auto VM::close_upvalues(const Value* last) -> void {
+    while(!open_upvalues.empty()) {
+        auto upvalue = open_upvalues.back().as_object<MintUpvalue>();
+        if(upvalue->location < last) break;
+
+        upvalue->closed = *upvalue->location;
+        upvalue->location = &upvalue->closed;
+        open_upvalues.pop_back();
+    }
+}
+
+auto VM::run() -> void {
+    auto frame = &frames.back();
+    auto ip = frame->ip;
+    auto slots = frame->slots;
+    auto chunk = &frame->closure->prototype->chunk;
+
+#define READ_BYTE() (*ip++)
+#define READ_SHORT() (ip += 2, static_cast<uint16_t>((ip[-2] << 8) | ip[-1]))
+#define TOKEN() (*chunk->tokens[ip - chunk->code.data() - 1])
+#define PUSH(value) (*stack_top++ = (value))
+#define DROP() (*--stack_top = Value())
+#define LOAD_FRAME() \
+    do { \
+        frame = &frames.back(); \
+        ip = frame->ip; \
+        slots = frame->slots; \
+        chunk = &frame->closure->prototype->chunk; \
+    } while(false)
+// Numbers of the same kind take the fast path, everything else goes
+// through the shared operator semantics
+#define NUMERIC_OP(op, integer_op) \
+    do { \
+        auto& a = stack_top[-2]; \
+        auto& b = stack_top[-1]; \
+        if(a.is_number() && b.is_number()) a = Value(a.as_number() op b.as_number()); \
+        else if(a.is_integer() && b.is_integer()) a = integer_op(a.as_integer(), b.as_integer()); \
+        else a = Operators::binary(TOKEN(), a, b); \
+        DROP(); \
+    } while(false)
+#define INTEGER_OP(integer_op) \
+    do { \
+        auto& a = stack_top[-2]; \
+        auto& b = stack_top[-1]; \
+        if(a.is_integer() && b.is_integer()) a = integer_op(a.as_integer(), b.as_integer()); \
+        else a = Operators::binary(TOKEN(), a, b); \
+        DROP(); \
+    } while(false)
+
+    while(true) {
+        switch(static_cast<opcode>(READ_BYTE())) {
+            case opcode::CONSTANT: PUSH(chunk->constants[READ_SHORT()]); break;
+            case opcode::NIL: PUSH(Value()); break;
+            case opcode::TRUE: PUSH(true); break;
+            case opcode::FALSE: PUSH(false); break;
+            case opcode::POP: DROP(); break;
+            case opcode::GET_LOCAL: PUSH(slots[READ_BYTE()]); break;
+            case opcode::SET_LOCAL: slots[READ_BYTE()] = stack_top[-1]; break;
+            case opcode::GET_UPVALUE: {
+                auto upvalue = frame->closure->upvalues[READ_BYTE()].as_object<MintUpvalue>();
+                PUSH(*upvalue->location);
+            }
+            break;
+            case opcode::SET_UPVALUE: {
+                auto upvalue = frame->closure->upvalues[READ_BYTE()].as_object<MintUpvalue>();
+                *upvalue->location = stack_top[-1];
+            }
+            break;
+            case opcode::GET_GLOBAL: {
+                const auto& global = globals[READ_SHORT()];
+                if(!global.defined)
+                    throw RuntimeError(TOKEN(), "Undefined variable '" + std::string(TOKEN().lexeme) + "'");
+                PUSH(global.value);
+            }
+            break;
+            case opcode::SET_GLOBAL: {
+                auto& global = globals[READ_SHORT()];
+                if(!global.defined)
+                    throw RuntimeError(TOKEN(), "Undefined variable '" + std::string(TOKEN().lexeme) + "'");
+                global.value = stack_top[-1];
+            }
+            break;
+            case opcode::DEFINE_GLOBAL: {
+                auto& global = globals[READ_SHORT()];
+                global.value = std::move(stack_top[-1]);
+                global.defined = true;
+                DROP();
+            }
+            break;
+            case opcode::EQUAL: {
+                auto& a = stack_top[-2];
+                a = Operators::is_equal(a, stack_top[-1]);
+                DROP();
+            }
+            break;
+            case opcode::NOT_EQUAL: {
+                auto& a = stack_top[-2];
+                a = !Operators::is_equal(a, stack_top[-1]);
+                DROP();
+            }
+            break;
+            case opcode::GREATER: NUMERIC_OP(>, std::greater<>()); break;
+            case opcode::GREATER_EQUAL: NUMERIC_OP(>=, std::greater_equal<>()); break;
+            case opcode::LESS: NUMERIC_OP(<, std::less<>()); break;
+            case opcode::LESS_EQUAL: NUMERIC_OP(<=, std::less_equal<>()); break;
+            case opcode::ADD: NUMERIC_OP(+, Operators::add); break;
+            case opcode::SUBTRACT: NUMERIC_OP(-, Operators::subtract); break;
+            case opcode::MULTIPLY: NUMERIC_OP(*, Operators::multiply); break;
+            case opcode::DIVIDE: NUMERIC_OP(/, Operators::divide); break;
+            case opcode::MODULO: {
+                auto& a = stack_top[-2];
+                auto& b = stack_top[-1];
+                if(a.is_number() && b.is_number()) a = std::fmod(a.as_number(), b.as_number());
+                else if(a.is_integer() && b.is_integer()) a = Operators::modulo(a.as_integer(), b.as_integer());
+                else a = Operators::binary(TOKEN(), a, b);
+                DROP();
+            }
+            break;
+            case opcode::BIT_AND: INTEGER_OP(std::bit_and<>()); break;
+            case opcode::BIT_OR: INTEGER_OP(std::bit_or<>()); break;
+            case opcode::XOR: INTEGER_OP(std::bit_xor<>()); break;
+            case opcode::LEFT_SHIFT: INTEGER_OP(Operators::shift_left); break;
+            case opcode::RIGHT_SHIFT: INTEGER_OP(Operators::shift_right); break;
+            case opcode::NOT: stack_top[-1] = !Operators::is_truthy(stack_top[-1]); break;
+            case opcode::NEGATE: {
+                auto& a = stack_top[-1];
+                if(a.is_number()) a = -a.as_number();
+                else if(a.is_integer()) a = Operators::negate(a.as_integer());
+                else a = Operators::unary(TOKEN(), a);
+            }
+            break;
+            case opcode::BIT_NOT: stack_top[-1] = Operators::unary(TOKEN(), stack_top[-1]); break;
+            case opcode::PRINT: {
+                Output::print(stack_top[-1]);
+                DROP();
+            }
+            break;
+            case opcode::JUMP: {
+                auto offset = READ_SHORT();
+                ip += offset;
+            }
+            break;
+            case opcode::JUMP_IF_FALSE: {
+                auto offset = READ_SHORT();
+                if(!Operators::is_truthy(stack_top[-1])) ip += offset;
+            }
+            break;
+            case opcode::LOOP: {
+                auto offset = READ_SHORT();
+                ip -= offset;
+            }
+            break;
+            case opcode::CALL: {
+                auto arg_count = READ_BYTE();
+                frame->ip = ip;
+                call(stack_top[-1 - arg_count], arg_count, TOKEN());
+                LOAD_FRAME();
+            }
+            break;
+            case opcode::CLOSURE: {
+                auto prototype = chunk->constants[READ_SHORT()].as_object<MintPrototype>();
+                auto closure = new MintClosure(prototype);
+                PUSH(Value(closure));
+
+                for(auto i = 0U; i < prototype->upvalue_count; i++) {
+                    auto is_local = READ_BYTE();
+                    auto index = READ_BYTE();
+                    if(is_local) closure->upvalues.push_back(capture_upvalue(slots + index));
+                    else closure->upvalues.push_back(frame->closure->upvalues[index]);
+                }
+            }
+            break;
+            case opcode::CLOSE_UPVALUE: {
+                close_upvalues(stack_top - 1);
+                DROP();
+            }
+            break;
+            case opcode::TAIL_CALL: {
+                auto arg_count = READ_BYTE();
+                frame->ip = ip;
+                auto native = stack_top[-1 - arg_count].is_native();
+                call(stack_top[-1 - arg_count], arg_count, TOKEN());
+                // Natives leave their result in place: return it
+                if(native) goto return_value;
+                // Slide the callee and its arguments over the frame of the
+                // caller, which the new frame then replaces
+                auto callee = stack_top - 1 - arg_count;
+                close_upvalues(slots);
+                std::move(callee, stack_top, slots);
+                while(stack_top > slots + arg_count + 1) DROP();
+                frames.back().slots = slots;
+                frames[frames.size() - 2] = frames.back();
+                frames.pop_back();
+                LOAD_FRAME();
+            }
+            break;
+            case opcode::RETURN: return_value: {
+                auto result = std::move(stack_top[-1]);
+                close_upvalues(slots);
+                frames.pop_back();
+                while(stack_top > slots) DROP();
+
+                if(frames.empty()) return;
+
+                PUSH(std::move(result));
+                LOAD_FRAME();
+            }
+            break;
+        }
+    }
+
+#undef READ_BYTE
+#undef READ_SHORT
+#undef TOKEN
+#undef PUSH
+#undef DROP
+#undef LOAD_FRAME
+#undef NUMERIC_OP
+#undef INTEGER_OP
+}
@@ -0,0 +1,87 @@
+/*
+ * Mint interpreter
+ * Developed by Marco Cetica (c) 2022
+ * Released under GPLv3
+ *
+ */
+#pragma once
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Chunk.h"
+#include "Stmt.h"
+#include "Collector.h"
+
+class MintNative;
+
+/*
+ * A captured variable. While the variable is still on the VM stack
+ * the upvalue points to its slot, once the variable goes out of scope
+ * its value is moved into the upvalue itself.
+ */
+class MintUpvalue : public CollectableObject<Object> {
+public:
+    explicit MintUpvalue(Value* location) : CollectableObject(object_type::UPVALUE), location(location) {};
+    std::string to_string() override { return "<upvalue>"; }
+    // An open upvalue does not own the stack slot it points to
+    auto traverse(const Visitor& visit) -> void override {
+        if(location == &closed) Collector::visit(closed, visit);
+    }
+    auto clear() -> void override { closed = Value(); }
+
+    Value* location;
+    Value closed;
+};
+
+class MintClosure : public CollectableObject<Object> {
+public:
+    explicit MintClosure(MintPrototype* prototype)
+        : CollectableObject(object_type::CLOSURE), function(prototype), prototype(prototype) {
+        upvalues.reserve(prototype->upvalue_count);
+    };
+    std::string to_string() override { return prototype->to_string(); }
+    auto traverse(const Visitor& visit) -> void override {
+        for(const auto& upvalue : upvalues)
+            Collector::visit(upvalue, visit);
+    }
+    auto clear() -> void override { upvalues.clear(); }
+
+    const Value function;
+    MintPrototype* const prototype;
+    std::vector<Value> upvalues;
+};
+
+class VM {
+public:
+    VM();
+    auto interpret(const std::vector<Stmt*>& statements) -> void;
+    auto global_slot(Symbol name) -> uint16_t;
+private:
+    struct CallFrame {
+        MintClosure* closure;
+        const uint8_t* ip;
+        Value* slots;
+    };
+    struct Global {
+        Value value;
+        bool defined = false;
+    };
+
+    auto run() -> void;
+    auto call(const Value& callee, uint8_t arg_count, const Token& paren) -> void;
+    // Whether a frame of 'prototype' starting at 'slots' fits on the stack
+    auto fits(const MintPrototype& prototype, const Value* slots) const -> bool;
+    auto call_native(const MintNative& native, uint8_t arg_count, const Token& paren) -> void;
+    auto capture_upvalue(Value* local) -> Value;
+    auto close_upvalues(const Value* last) -> void;
+    auto reset_stack() -> void;
+
+    std::vector<Value> stack;
+    Value* stack_top;
+    std::vector<CallFrame> frames;
+    // Upvalues still pointing into the stack, sorted by slot address
+    std::vector<Value> open_upvalues;
+    std::vector<Global> globals;
+    std::unordered_map<Symbol, uint16_t> global_slots;
+};
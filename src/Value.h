@@ -0,0 +1,183 @@
+/*
+ * Mint interpreter
+ * Developed by Marco Cetica (c) 2022
+ * Released under GPLv3
+ *
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+enum class value_type : uint8_t {
+    NIL, BOOL, NUMBER, INTEGER, OBJECT
+};
+
+enum class object_type : uint8_t {
+    STRING, CALLABLE, NATIVE,
+    // Bytecode VM objects
+    PROTOTYPE, CLOSURE, UPVALUE,
+    // Closure compiler objects
+    COMPILED_FUNCTION
+};
+
+class Collectable;
+
+/*
+ * Base class of every heap allocated runtime object.
+ * Objects are reference counted by the Value instances
+ * pointing to them; the interpreter is single threaded,
+ * so the counter does not need to be atomic.
+ */
+class Object {
+public:
+    explicit Object(object_type type) : type(type) {};
+    Object(const Object&) = delete;
+    auto operator=(const Object&) -> Object& = delete;
+    virtual ~Object() = default;
+    virtual std::string to_string() = 0;
+    // Objects that can hold references to other objects are
+    // tracked by the cycle collector
+    virtual auto collectable() -> Collectable* { return nullptr; }
+
+    const object_type type;
+    unsigned int ref_count = 0;
+};
+
+/*
+ * Strings are prefixes of a shared, append-only buffer. Concatenating
+ * onto the string that ends its buffer appends in place, so building a
+ * string piece by piece takes amortised linear time.
+ */
+class MintString : public Object {
+public:
+    explicit MintString(std::string chars)
+        : MintString(std::make_shared<std::string>(std::move(chars))) {};
+    std::string to_string() override { return std::string(chars()); }
+
+    [[nodiscard]] auto chars() const -> std::string_view { return {buffer->data(), length}; }
+
+    static auto concat(const MintString* left, const MintString* right) -> MintString* {
+        // The buffer is already extended past 'left', views of it are held
+        // by the interner, or 'right' would be read while appending
+        if(left->length != left->buffer->size() || left->interned || left->buffer == right->buffer) {
+            std::string chars;
+            chars.reserve(left->length + right->length);
+            chars.append(left->chars()).append(right->chars());
+
+            return new MintString(std::move(chars));
+        }
+        left->buffer->append(right->chars());
+
+        return new MintString(left->buffer);
+    }
+
+    // Set by the interner: two distinct interned strings never compare equal
+    bool interned = false;
+
+private:
+    explicit MintString(std::shared_ptr<std::string> buffer)
+        : Object(object_type::STRING), buffer(std::move(buffer)), length(this->buffer->size()) {};
+
+    const std::shared_ptr<std::string> buffer;
+    const size_t length;
+};
+
+/*
+ * A Mint runtime value. Numbers, booleans and nil are stored inline,
+ * everything else is a handle to a reference counted Object. The whole
+ * value fits in 16 bytes and copying a number never touches the heap.
+ * Numbers are either doubles or 64-bit integers: integral literals and
+ * integer arithmetic that does not overflow produce integers.
+ */
+class Value {
+public:
+    Value() noexcept : type(value_type::NIL) { as.number = 0; };
+    Value(std::nullptr_t) noexcept : Value() {};
+    Value(bool boolean) noexcept : type(value_type::BOOL) { as.number = 0; as.boolean = boolean; };
+    Value(double number) noexcept : type(value_type::NUMBER) { as.number = number; };
+    Value(int64_t integer) noexcept : type(value_type::INTEGER) { as.integer = integer; };
+    template<class T, std::enable_if_t<std::is_base_of_v<Object, T>, int> = 0>
+    explicit Value(T* object) noexcept : type(value_type::OBJECT) {
+        as.object = object;
+        as.object->ref_count++;
+    }
+    // Prevent raw pointers(i.e., string literals) from silently decaying to bool
+    Value(const void*) = delete;
+
+    Value(const Value& other) noexcept : type(other.type), as(other.as) { retain(); };
+    Value(Value&& other) noexcept : type(other.type), as(other.as) { other.type = value_type::NIL; };
+    ~Value() { release(); };
+
+    auto operator=(const Value& other) noexcept -> Value& {
+        other.retain();
+        release();
+        type = other.type;
+        as = other.as;
+
+        return *this;
+    }
+
+    auto operator=(Value&& other) noexcept -> Value& {
+        if(this != &other) {
+            release();
+            type = other.type;
+            as = other.as;
+            other.type = value_type::NIL;
+        }
+
+        return *this;
+    }
+
+    static auto string(std::string chars) -> Value {
+        return Value(new MintString(std::move(chars)));
+    }
+
+    [[nodiscard]] auto is_nil() const -> bool { return type == value_type::NIL; }
+    [[nodiscard]] auto is_bool() const -> bool { return type == value_type::BOOL; }
+    [[nodiscard]] auto is_number() const -> bool { return type == value_type::NUMBER; }
+    [[nodiscard]] auto is_integer() const -> bool { return type == value_type::INTEGER; }
+    // Either kind of number
+    [[nodiscard]] auto is_numeric() const -> bool { return is_number() || is_integer(); }
+    [[nodiscard]] auto is_object() const -> bool { return type == value_type::OBJECT; }
+    [[nodiscard]] auto is_string() const -> bool { return is_object() && as.object->type == object_type::STRING; }
+    [[nodiscard]] auto is_callable() const -> bool {
+        return is_object() && (as.object->type == object_type::CALLABLE || as.object->type == object_type::NATIVE);
+    }
+    [[nodiscard]] auto is_native() const -> bool { return is_object() && as.object->type == object_type::NATIVE; }
+
+    [[nodiscard]] auto as_bool() const -> bool { return as.boolean; }
+    [[nodiscard]] auto as_number() const -> double { return as.number; }
+    [[nodiscard]] auto as_integer() const -> int64_t { return as.integer; }
+    // Value of either kind of number as a double
+    [[nodiscard]] auto to_number() const -> double {
+        return is_integer() ? static_cast<double>(as.integer) : as.number;
+    }
+    [[nodiscard]] auto as_string() const -> std::string_view { return static_cast<MintString*>(as.object)->chars(); }
+    template<class T = Object>
+    [[nodiscard]] auto as_object() const -> T* { return static_cast<T*>(as.object); }
+
+private:
+    auto retain() const noexcept -> void {
+        if(type == value_type::OBJECT) as.object->ref_count++;
+    }
+
+    auto release() noexcept -> void {
+        if(type == value_type::OBJECT && --as.object->ref_count == 0)
+            delete as.object;
+    }
+
+    value_type type;
+    union {
+        bool boolean;
+        double number;
+        int64_t integer;
+        Object* object;
+    } as{};
+};
+
+static_assert(sizeof(Value) <= 16, "Value must stay within two machine words");
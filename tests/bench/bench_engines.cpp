@@ -0,0 +1,74 @@
+#include <sstream>
+#include <iostream>
+#include "benchmark/benchmark.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "Resolver.h"
+#include "Interpreter.h"
+#include "VM.h"
+#include "ClosureCompiler.h"
+
+static const std::string fib_src =
+        "function fib(n) {\n"
+        "    if(n <= 2) return n;\n"
+        "    return fib(n - 2) + fib(n - 1);\n"
+        "}\n"
+        "let result = fib(20);\n";
+
+static const std::string calls_src =
+        "function sum(n, acc) {\n"
+        "    if(n == 0) return acc;\n"
+        "    return sum(n - 1, acc + n);\n"
+        "}\n"
+        "for(let i = 0; i < 100; i = i + 1) sum(500, 0);\n";
+
+static const std::string loop_src =
+        "let sum = 0;\n"
+        "for(let i = 0; i < 100000; i = i + 1) {\n"
+        "    if((i % 3 == 0) || (i % 5 == 0)) sum = sum + i;\n"
+        "}\n";
+
+static const std::string closure_src =
+        "function make_counter() {\n"
+        "    let count = 0;\n"
+        "    function counter() { count = count + 1; return count; }\n"
+        "    return counter;\n"
+        "}\n"
+        "let total = 0;\n"
+        "for(let i = 0; i < 10000; i = i + 1) total = total + make_counter()();\n";
+
+static const std::string concat_src =
+        "let str = \"\";\n"
+        "for(let i = 0; i < 1000; i = i + 1) str = str + \"FizzBuzz\";\n";
+
+// Runs an already resolved program with the engine selected by the first argument
+static auto run_engine(benchmark::State& state, const std::string& source) -> void {
+    Lexer lexer(source);
+    auto tokens = lexer.scan_tokens();
+    Parser parser(tokens);
+    auto program = parser.parse();
+    const auto& statements = program.statements;
+    auto engine = state.range(0);
+    Resolver resolver(engine == 0);
+    resolver.resolve(statements);
+
+    Interpreter interpreter;
+    VM vm;
+    ClosureCompiler closure_compiler;
+
+    for(auto _ : state) {
+        switch(engine) {
+            case 1: vm.interpret(statements); break;
+            case 2: closure_compiler.interpret(statements); break;
+            default: interpreter.interpret(statements);
+        }
+    }
+
+    state.SetLabel(engine == 1 ? "vm" : engine == 2 ? "closure" : "tree");
+}
+
+BENCHMARK_CAPTURE(run_engine, fibonacci_rec, fib_src)->Arg(0)->Arg(1)->Arg(2)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(run_engine, recursive_calls, calls_src)->Arg(0)->Arg(1)->Arg(2)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(run_engine, numeric_loop, loop_src)->Arg(0)->Arg(1)->Arg(2)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(run_engine, closures, closure_src)->Arg(0)->Arg(1)->Arg(2)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(run_engine, string_concat, concat_src)->Arg(0)->Arg(1)->Arg(2)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,91 @@
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include "benchmark/benchmark.h"
+#include "Source.h"
+#include "Program.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "Resolver.h"
+#include "Optimizer.h"
+#include "Interpreter.h"
+#include "VM.h"
+#include "ClosureCompiler.h"
+#include "Output.h"
+
+// Runs an example this many times by default: on its own, each one finishes in microseconds
+constexpr auto RUNS = 100;
+
+static const char* engine_names[] = {"tree", "vm", "closure"};
+
+// Reads a script and wraps it in a loop running it 'runs' times, then parses
+// and optimises it like the interpreter does. The script's globals become
+// locals of the loop body, so each run starts from the same state
+static auto load_script(const std::string& path, int64_t runs, int engine) -> Program {
+    std::stringstream text;
+    text << "for(let example_run = 0; example_run < " << runs << "; example_run = example_run + 1) {\n"
+         << std::ifstream(path).rdbuf() << "\n}\n";
+
+    auto source = std::make_unique<const Source>(text.str());
+    auto tokens = Lexer(source->text()).scan_tokens();
+    auto program = Parser(tokens).parse();
+    program.source = std::move(source);
+    Resolver(engine == 0).resolve(program.statements);
+    Optimizer(program).optimize();
+
+    return program;
+}
+
+static auto run_example(benchmark::State& state, const std::string& path, int engine) -> void {
+    auto runs = state.range(0);
+    auto program = load_script(path, runs, engine);
+    const auto& statements = program.statements;
+
+    // Printed values are formatted and buffered as usual, then discarded
+    auto null = open("/dev/null", O_WRONLY);
+    Output::redirect(null);
+
+    Interpreter interpreter;
+    VM vm;
+    ClosureCompiler closure_compiler;
+    for(auto _ : state) {
+        switch(engine) {
+            case 1: vm.interpret(statements); break;
+            case 2: closure_compiler.interpret(statements); break;
+            default: interpreter.interpret(statements);
+        }
+    }
+
+    Output::flush();
+    Output::redirect(-1);
+    close(null);
+    state.SetItemsProcessed(state.iterations() * runs);
+    state.SetLabel(engine_names[engine]);
+}
+
+// One benchmark per example and engine, named after the script
+static auto register_examples() -> bool {
+    std::vector<std::filesystem::path> scripts;
+    for(const auto& entry : std::filesystem::directory_iterator(MINT_EXAMPLES_DIR))
+        scripts.push_back(entry.path());
+    std::sort(scripts.begin(), scripts.end());
+
+    for(const auto& script : scripts) {
+        for(auto engine = 0; engine < 3; engine++) {
+            auto name = "example/" + script.stem().string() + "/" + engine_names[engine];
+            benchmark::RegisterBenchmark(name.c_str(), run_example, script.string(), engine)
+                    ->Arg(RUNS)
+                    ->Unit(benchmark::kMillisecond);
+        }
+    }
+
+    return true;
+}
+
+static const auto registered = register_examples();
@@ -0,0 +1,56 @@
+#include <string>
+#include "benchmark/benchmark.h"
+#include "Lexer.h"
+#include "Scanner.h"
+#include "bench_source.h"
+
+static const std::string code_snippet =
+        "function fibonacci_iterative(limit) {\n"
+        "    let previous = 0;\n"
+        "    let current = 1;\n"
+        "    for(let i = 0; i < limit; i = i + 1) {\n"
+        "        let next = previous + current; // advance the sequence\n"
+        "        previous = current;\n"
+        "        current = next * 1.5 - 0.25;\n"
+        "    }\n"
+        "    return current;\n"
+        "}\n\n";
+
+static const std::string string_snippet =
+        "print \"Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor.\";\n";
+
+static const std::string comment_snippet =
+        "        // Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor.\n"
+        "        let x = 1;\n";
+
+// Scanning throughput over roughly 1 MB of source
+static auto scan_tokens(benchmark::State& state, const std::string& snippet) -> void {
+    auto source = repeat(snippet, 1 << 20);
+
+    for(auto _ : state) {
+        Lexer lexer(source);
+        auto tokens = lexer.scan_tokens();
+        benchmark::DoNotOptimize(tokens.data());
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * source.size()));
+    state.SetLabel(Scanner::isa());
+}
+
+// Same as above on 16 MB of code, split among 'state.range(0)' threads
+static auto scan_tokens_parallel(benchmark::State& state) -> void {
+    auto source = repeat(code_snippet + string_snippet + comment_snippet, 16 << 20);
+    auto threads = static_cast<unsigned int>(state.range(0));
+
+    for(auto _ : state) {
+        auto tokens = Lexer::scan_tokens_parallel(source, threads);
+        benchmark::DoNotOptimize(tokens.data());
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * source.size()));
+}
+
+BENCHMARK_CAPTURE(scan_tokens, code, code_snippet)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(scan_tokens, strings, string_snippet)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(scan_tokens, comments, comment_snippet)->Unit(benchmark::kMillisecond);
+BENCHMARK(scan_tokens_parallel)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Unit(benchmark::kMillisecond)->UseRealTime();
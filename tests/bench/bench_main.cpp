@@ -0,0 +1,26 @@
+#include <cstring>
+#include <string>
+#include <vector>
+#include "benchmark/benchmark.h"
+
+/*
+ * Same as the main function of Google Benchmark, except that results
+ * are reported as JSON unless another format is requested, so that they
+ * can be compared release over release.
+ */
+int main(int argc, char **argv) {
+    std::vector<char*> args(argv, argv + argc);
+    std::string json_format = "--benchmark_format=json";
+    auto has_format = false;
+    for(auto i = 1; i < argc; i++)
+        if(std::strncmp(argv[i], "--benchmark_format", 18) == 0) has_format = true;
+    if(!has_format) args.insert(args.begin() + 1, json_format.data());
+
+    auto count = static_cast<int>(args.size());
+    benchmark::Initialize(&count, args.data());
+    if(benchmark::ReportUnrecognizedArguments(count, args.data())) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    return 0;
+}
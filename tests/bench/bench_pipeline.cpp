@@ -0,0 +1,106 @@
+#include <string>
+#include "benchmark/benchmark.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "Resolver.h"
+#include "Interpreter.h"
+#include "bench_source.h"
+
+static const std::string code_snippet =
+        "function collatz(n) {\n"
+        "    let steps = 0;\n"
+        "    while(n != 1) {\n"
+        "        if(n % 2 == 0) n = n / 2; else n = 3 * n + 1;\n"
+        "        steps = steps + 1;\n"
+        "    }\n"
+        "    return steps;\n"
+        "}\n"
+        "{\n"
+        "    let longest = 0;\n"
+        "    for(let i = 1; i < 100; i = i + 1) { let s = collatz(i); if(s > longest) longest = s; }\n"
+        "    print \"longest: \" + \"chain\";\n"
+        "}\n";
+
+// Parsing throughput over roughly 256 KB of source
+static auto parse(benchmark::State& state) -> void {
+    auto source = repeat(code_snippet, 256 << 10);
+    auto tokens = Lexer(source).scan_tokens();
+
+    for(auto _ : state) {
+        auto program = Parser(tokens).parse();
+        benchmark::DoNotOptimize(program.statements.data());
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * source.size()));
+}
+
+// Resolution of the same source, in frames mode when 'state.range(0)' is set
+static auto resolve(benchmark::State& state) -> void {
+    auto source = repeat(code_snippet, 256 << 10);
+    auto tokens = Lexer(source).scan_tokens();
+
+    for(auto _ : state) {
+        // Resolution annotates the tree, so every run gets a fresh one
+        state.PauseTiming();
+        auto program = Parser(tokens).parse();
+        state.ResumeTiming();
+
+        Resolver(state.range(0) != 0).resolve(program.statements);
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * source.size()));
+}
+
+/*
+ * Tree interpreter paths. Every program repeats the statement being
+ * measured OPERATIONS times in a counted loop, which is itself cheap.
+ */
+constexpr auto OPERATIONS = 10000;
+
+static auto interpret(benchmark::State& state, const std::string& source) -> void {
+    auto tokens = Lexer(source).scan_tokens();
+    auto program = Parser(tokens).parse();
+    Resolver(true).resolve(program.statements);
+    Interpreter interpreter;
+
+    for(auto _ : state)
+        interpreter.interpret(program.statements);
+
+    state.SetItemsProcessed(state.iterations() * OPERATIONS);
+}
+
+static auto loop(const std::string& body) -> std::string {
+    return "for(let i = 0; i < " + std::to_string(OPERATIONS) + "; i = i + 1) " + body + "\n";
+}
+
+static auto binary_arithmetic(benchmark::State& state) -> void {
+    interpret(state, "{ let x = 3; let y = 0.5; let r = 0;\n" + loop("r = x * y + x - y % x;") + "}\n");
+}
+
+// Reads a variable declared 'state.range(0)' scopes above the loop
+static auto variable_lookup(benchmark::State& state) -> void {
+    auto depth = state.range(0);
+    std::string source = "{ let v = 1; let r = 0;\n";
+    for(auto i = 1; i < depth; i++) source += "{ let d" + std::to_string(i) + " = " + std::to_string(i) + ";\n";
+    source += loop("{ let w = 0; r = v; }");
+    for(auto i = 1; i < depth; i++) source += "}\n";
+    source += "}\n";
+
+    interpret(state, source);
+}
+
+static auto function_call(benchmark::State& state) -> void {
+    interpret(state, "function add(a, b) { return a + b; }\n"
+                     "{ let r = 0;\n" + loop("r = add(r, i);") + "}\n");
+}
+
+static auto string_concat(benchmark::State& state) -> void {
+    interpret(state, "{ let s = \"\";\n" + loop("s = s + \"ab\";") + "}\n");
+}
+
+BENCHMARK(parse)->Unit(benchmark::kMillisecond);
+BENCHMARK(resolve)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+BENCHMARK(binary_arithmetic)->Unit(benchmark::kMicrosecond);
+BENCHMARK(variable_lookup)->Arg(1)->Arg(4)->Arg(16)->Unit(benchmark::kMicrosecond);
+BENCHMARK(function_call)->Unit(benchmark::kMicrosecond);
+BENCHMARK(string_concat)->Unit(benchmark::kMicrosecond);
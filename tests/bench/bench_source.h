@@ -0,0 +1,18 @@
+/*
+ * Mint interpreter
+ * Developed by Marco Cetica (c) 2022
+ * Released under GPLv3
+ *
+ */
+#pragma once
+#include <cstddef>
+#include <string>
+
+// Builds about 'size' bytes of source by repeating 'snippet'
+inline auto repeat(const std::string& snippet, size_t size) -> std::string {
+    std::string source;
+    source.reserve(size + snippet.size());
+    while(source.size() < size) source += snippet;
+
+    return source;
+}
@@ -0,0 +1,54 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Arena.h"
+#include "gtest/gtest.h"
+
+struct Tracked {
+    Tracked(std::vector<int>& log, int id) : log(log), id(id) {};
+    ~Tracked() { log.push_back(id); }
+
+    std::vector<int>& log;
+    int id;
+};
+
+TEST(ArenaTest, TestDestructorsRunNewestFirst) {
+    std::vector<int> log;
+    {
+        Arena arena;
+        for(auto i = 0; i < 3; i++)
+            arena.make<Tracked>(log, i);
+        ASSERT_TRUE(log.empty());
+    }
+
+    ASSERT_EQ(log, (std::vector<int>{2, 1, 0}));
+}
+
+TEST(ArenaTest, TestAlignmentAndLargeObjects) {
+    struct alignas(64) Aligned { char data[64]; };
+    struct Large { char data[100 * 1024]; };
+    Arena arena;
+
+    arena.make<char>('x');
+    auto aligned = arena.make<Aligned>();
+    auto large = arena.make<Large>();
+    auto str = arena.make<std::string>(1000, 'a');
+
+    ASSERT_EQ(reinterpret_cast<std::uintptr_t>(aligned) % 64, 0U);
+    ASSERT_NE(large, nullptr);
+    ASSERT_EQ(str->size(), 1000U);
+}
+
+TEST(ArenaTest, TestMoveTransfersOwnership) {
+    std::vector<int> log;
+    Arena target;
+    {
+        Arena source;
+        source.make<Tracked>(log, 1);
+        target = std::move(source);
+    }
+
+    ASSERT_TRUE(log.empty());
+    target = Arena();
+    ASSERT_EQ(log, (std::vector<int>{1}));
+}
@@ -0,0 +1,59 @@
+#include "Collector.h"
+#include "Environment.h"
+#include "MintFunction.h"
+#include "gtest/gtest.h"
+
+// An environment holding a function that closes over it
+static auto make_cycle() -> std::shared_ptr<Environment> {
+    auto env = std::make_shared<Environment>();
+    env->define(Value(new MintFunction(nullptr, env)));
+
+    return env;
+}
+
+TEST(CollectorTest, TestCycleIsCollected) {
+    Collector::set_threshold(0);
+    // Drop garbage left behind by other tests
+    Collector::collect();
+    auto before = Collector::stats().tracked;
+
+    make_cycle();
+    ASSERT_EQ(Collector::stats().tracked, before + 2);
+    ASSERT_EQ(Collector::collect(), 2);
+    ASSERT_EQ(Collector::stats().tracked, before);
+
+    Collector::set_threshold(Collector::DEFAULT_THRESHOLD);
+}
+
+TEST(CollectorTest, TestReachableCycleSurvives) {
+    Collector::set_threshold(0);
+    // Drop garbage left behind by other tests
+    Collector::collect();
+    auto before = Collector::stats().tracked;
+
+    auto env = make_cycle();
+    auto inner = std::make_shared<Environment>(env);
+    ASSERT_EQ(Collector::collect(), 0);
+
+    env.reset();
+    ASSERT_EQ(Collector::collect(), 0);
+    inner.reset();
+    ASSERT_EQ(Collector::collect(), 2);
+    ASSERT_EQ(Collector::stats().tracked, before);
+
+    Collector::set_threshold(Collector::DEFAULT_THRESHOLD);
+}
+
+TEST(CollectorTest, TestThresholdTriggersCollection) {
+    Collector::set_threshold(10);
+    auto collections = Collector::stats().collections;
+    auto before = Collector::stats().tracked;
+
+    for(auto i = 0; i < 100; i++)
+        make_cycle();
+
+    ASSERT_GT(Collector::stats().collections, collections);
+    ASSERT_LE(Collector::stats().tracked, before + 20);
+
+    Collector::set_threshold(Collector::DEFAULT_THRESHOLD);
+}
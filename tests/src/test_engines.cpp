@@ -0,0 +1,326 @@
+#include <filesystem>
+#include "test_mint.h"
+#include "Collector.h"
+
+// Every engine must produce the same output as the tree-walking interpreter
+class EngineTest : public MintTest, public ::testing::WithParamInterface<engine_type> {
+protected:
+    auto SetUp() -> void override {
+        MintTest::SetUp();
+        Mint::set_engine(GetParam());
+    }
+};
+
+TEST_P(EngineTest, TestFactorial) {
+    ASSERT_EQ(eval(fact_src), "120\n");
+}
+
+TEST_P(EngineTest, TestControlFlow) {
+    auto actual = eval(
+            "let sum = 0;\n"
+            "for(let i = 0; i < 10; i = i + 1) {\n"
+            "  if(i % 2 == 0 && i != 4) sum = sum + i;\n"
+            "  else if(i == 9 || false) sum = sum * 2;\n"
+            "}\n"
+            "while(sum > 50) sum = sum - 7;\n"
+            "print sum;\n"
+            "print !nil == true;\n");
+
+    ASSERT_EQ(actual, "32\ntrue\n");
+}
+
+TEST_P(EngineTest, TestSharedUpvalues) {
+    auto actual = eval(
+            "function pair() {\n"
+            "  let x = 0;\n"
+            "  function inc() { x = x + 1; return x; }\n"
+            "  function get() { return x; }\n"
+            "  inc(); inc();\n"
+            "  return get;\n"
+            "}\n"
+            "let get = pair();\n"
+            "print get();\n"
+            "let fns = nil;\n"
+            "for(let i = 0; i < 3; i = i + 1) {\n"
+            "  let j = i * 10;\n"
+            "  function f() { return j; }\n"
+            "  if(i == 1) fns = f;\n"
+            "}\n"
+            "print fns();\n"
+            "print get;\n");
+
+    ASSERT_EQ(actual, "2\n10\n<fn get>\n");
+}
+
+TEST_P(EngineTest, TestNestedReturn) {
+    auto actual = eval(
+            "function find(limit) {\n"
+            "  for(let i = 0; i < 100; i = i + 1) {\n"
+            "    { if(i * i > limit) return i; }\n"
+            "  }\n"
+            "  return nil;\n"
+            "}\n"
+            "function noop() { return; }\n"
+            "print find(50) + find(10);\n"
+            "print noop();\n"
+            "for(let i = 0; i < 2; i = i + 1) print find(i);\n");
+
+    ASSERT_EQ(actual, "12\nnil\n1\n2\n");
+}
+
+TEST_P(EngineTest, TestCountedLoops) {
+    auto actual = eval(
+            "let out = \"\";\n"
+            "for(let i = 10; i > 0; i = i - 3) out = out + \"x\";\n"
+            "print out;\n"
+            "for(let i = 0; i < 10; i = i + 1) { if(i == 2) i = 7; print i; }\n"
+            "for(let i = 0; i != 3; i = i + 1) { if(i == 1) i = \"a\"; print i; }\n");
+
+    ASSERT_EQ(actual, "xxxx\n0\n1\n7\n8\n9\n0\na\n");
+    ASSERT_EQ(err_stream.str(), "[Line 5] Operands must be two numbers or two strings.\n");
+}
+
+TEST_P(EngineTest, TestCountedLoopLimits) {
+    auto actual = eval(
+            "let n = 3;\n"
+            "let runs = 0;\n"
+            "for(let i = 0; i < n; i = i + 1) { n = n - 1; runs = runs + 1; }\n"
+            "print runs;\n"
+            "for(let i = 0; i < \"3\"; i = i + 1) print i;\n");
+
+    ASSERT_EQ(actual, "2\n");
+    ASSERT_EQ(err_stream.str(), "[Line 5] Operands must be numbers.\n");
+}
+
+TEST_P(EngineTest, TestCountedLoopLimitEffects) {
+    auto actual = eval(
+            "function f() {\n"
+            "  let runs = 0;\n"
+            "  for(let i = 0; i < (i = i + 2); i = i + 1) { runs = runs + 1; if(runs == 5) return i; }\n"
+            "}\n"
+            "print f();\n"
+            "function g() {\n"
+            "  let runs = 0;\n"
+            "  let i = 0;\n"
+            "  function bump() { i = i + 10; return 100; }\n"
+            "  for(; i < bump(); i = i + 1) runs = runs + 1;\n"
+            "  return runs;\n"
+            "}\n"
+            "print g();\n");
+
+    ASSERT_EQ(actual, "14\n10\n");
+}
+
+TEST_P(EngineTest, TestDeclarationFreeBlocks) {
+    auto actual = eval(
+            "let g = 1;\n"
+            "{ { g = g + 1; } print g; }\n"
+            "function f(n) {\n"
+            "  let x = n;\n"
+            "  { { x = x * 2; } { let y = x + 1; { x = y; } } }\n"
+            "  let get = nil;\n"
+            "  while(x < 100) { x = x * 3; { function h() { return x; } get = h; } }\n"
+            "  return get;\n"
+            "}\n"
+            "print f(2)();\n");
+
+    ASSERT_EQ(actual, "2\n135\n");
+}
+
+TEST_P(EngineTest, TestGlobalRedefinition) {
+    auto actual = eval(
+            "function get() { return x; }\n"
+            "function set(v) { x = v; }\n"
+            "let x = 1;\n"
+            "print get();\n"
+            "let x = 2;\n"
+            "print get();\n"
+            "set(3);\n"
+            "print x;\n"
+            "function get() { return -x; }\n"
+            "print get();\n");
+
+    ASSERT_EQ(actual, "1\n2\n3\n-3\n");
+}
+
+TEST_P(EngineTest, TestFunctionLocals) {
+    auto actual = eval(
+            "function shadow(a, b) {\n"
+            "  let c = a;\n"
+            "  { let a = b; c = c + a; { let a = 100; c = c + a; } }\n"
+            "  for(let i = 0; i < 3; i = i + 1) { let d; if(d == nil) d = i; c = c + d; }\n"
+            "  return c + a;\n"
+            "}\n"
+            "function outer(x) {\n"
+            "  let y = x * 2;\n"
+            "  function inner(z) { let w = z + 1; return x + y + w; }\n"
+            "  return inner(shadow(x, y));\n"
+            "}\n"
+            "print shadow(1, 2);\n"
+            "print outer(1);\n");
+
+    ASSERT_EQ(actual, "107\n111\n");
+}
+
+TEST_P(EngineTest, TestCallsAfterRuntimeError) {
+    auto actual = eval(
+            "function sum(n, acc) { if(n == 0) return acc + nil; return sum(n - 1, acc + n); }\n"
+            "print sum(10, 0);\n");
+    actual += eval(
+            "function add(a, b) { return a + b; }\n"
+            "print add(add(1, 2), add(3, 4));\n");
+
+    ASSERT_EQ(actual, "10\n");
+    ASSERT_EQ(err_stream.str(), "[Line 1] Operands must be two numbers or two strings.\n");
+}
+
+TEST_P(EngineTest, TestTailCalls) {
+    auto actual = eval(
+            "function sum(n, acc) { if(n == 0) return acc; return sum(n - 1, acc + n); }\n"
+            "function even(n) { if(n == 0) return true; return odd(n - 1); }\n"
+            "function odd(n) { if(n == 0) return false; return even(n - 1); }\n"
+            "function search(n) {\n"
+            "  let hits = 0;\n"
+            "  function hit() { hits = hits + 1; return hits; }\n"
+            "  for(let i = 0; i < 10; i = i + 1) { if(i == n) { hit(); return count(hits, i); } }\n"
+            "  return -1;\n"
+            "}\n"
+            "function count(a, b) { return a + b; }\n"
+            "print sum(100000, 0);\n"
+            "print even(100001);\n"
+            "print search(4);\n"
+            "function bad() { return nil(1); }\n"
+            "bad();\n");
+
+    ASSERT_EQ(actual, "5000050000\nfalse\n5\n");
+    ASSERT_EQ(err_stream.str(), "[Line 14] Can only call functions and classes.\n");
+}
+
+TEST_P(EngineTest, TestIntegers) {
+    auto actual = eval(
+            "let a = 12;\n"
+            "print (a & 10) + 1;\n"
+            "let h = 5381;\n"
+            "for(let i = 0; i < 20; i = i + 1) h = ((h << 5) + h + i) & 144115188075855871;\n"
+            "print h;\n"
+            "print 9223372036854775807 + 1 > 9223372036854775807;\n"
+            "print 7 / 2;\n"
+            "print -7 % 3;\n"
+            "print 1 << 65;\n"
+            "print ~0 ^ 1.9;\n"
+            "print 2 == 2.0;\n"
+            "let n = 0;\n"
+            "for(let i = 9223372036854775806; i > 0; i = i + 1) { print i; if(n == 2) i = -2; n = n + 1; }\n");
+
+    ASSERT_EQ(actual,
+              "9\n"
+              "104857088276151491\n"
+              "true\n"
+              "3.5\n"
+              "-1\n"
+              "2\n"
+              "-2\n"
+              "true\n"
+              "9223372036854775806\n"
+              "9223372036854775807\n"
+              "9223372036854775808\n");
+}
+
+TEST_P(EngineTest, TestNatives) {
+    auto actual = eval(
+            "function hypot(a, b) { return sqrt(a * a + b * b); }\n"
+            "function size(s) { return len(s); }\n"
+            "print hypot(3, 4);\n"
+            "print floor(-2.5) + len(\"mint\");\n"
+            "print size(\"\") == 0;\n"
+            "print sqrt(\"x\") == sqrt(\"x\");\n"
+            "print len(1);\n"
+            "print clock() - clock() <= 0;\n"
+            "print sqrt;\n"
+            "{ let sqrt = 2; print sqrt; }\n"
+            "floor(1, 2);\n");
+
+    ASSERT_EQ(actual, "5\n1\ntrue\nfalse\nnil\ntrue\n<native fn sqrt>\n2\n");
+    ASSERT_EQ(err_stream.str(), "[Line 11] Expected 1 arguments but got 2.\n");
+}
+
+TEST_P(EngineTest, TestStringConcatenation) {
+    auto actual = eval(
+            "let s = \"\";\n"
+            "for(let i = 0; i < 1000; i = i + 1) s = s + \"ab\";\n"
+            "let t = s + \"!\";\n"
+            "let u = s + \"?\";\n"
+            "print t == s + \"!\";\n"
+            "print u == t;\n"
+            "let w = \"x\";\n"
+            "w = w + w;\n"
+            "print w + \"y\";\n");
+
+    ASSERT_EQ(actual, "true\nfalse\nxxy\n");
+}
+
+TEST_P(EngineTest, TestRuntimeError) {
+    auto actual = eval(
+            "print \"before\";\n"
+            "function f(a) { return a; }\n"
+            "f(1, 2);\n"
+            "print \"after\";\n");
+
+    ASSERT_EQ(actual, "before\n");
+    ASSERT_EQ(err_stream.str(), "[Line 3] Expected 1 arguments but got 2.\n");
+}
+
+TEST_P(EngineTest, TestLargeFrames) {
+    // 200 locals and an expression 600 operands deep, at a call depth close to the stack size of the VM
+    std::string locals, expression = "n";
+    for(auto i = 0; i < 200; i++) locals += "let l" + std::to_string(i) + " = n; ";
+    for(auto i = 0; i < 600; i++) expression = "(1 + " + expression + ")";
+    auto source = "function f(n, depth) { " + locals + "if(depth == 0) return " + expression + "; return f(n, depth - 1) + 1; }\n";
+
+    auto actual = eval(source + "print f(0, 1200);\n" + "print f(0, 1288);\n");
+
+    // The frames of the VM outgrow its stack first
+    if(GetParam() == engine_type::VM) {
+        ASSERT_EQ(actual, "1800\n");
+        ASSERT_EQ(err_stream.str(), "[Line 1] Stack overflow.\n");
+    } else {
+        ASSERT_EQ(actual, "1800\n1888\n");
+        ASSERT_EQ(err_stream.str(), "");
+    }
+}
+
+TEST_P(EngineTest, TestClosureCyclesAreCollected) {
+    auto before = Collector::stats().tracked;
+    auto actual = eval(
+            "function make_cycle() {\n"
+            "  let count = 0;\n"
+            "  function counter() { count = count + 1; return counter; }\n"
+            "  return counter;\n"
+            "}\n"
+            "for(let i = 0; i < 100; i = i + 1) make_cycle()();\n"
+            "print \"done\";\n");
+    Collector::collect();
+
+    ASSERT_EQ(actual, "done\n");
+    // Only the global function survives
+    ASSERT_LE(Collector::stats().tracked, before + 1);
+}
+
+TEST_P(EngineTest, TestExamplesMatchInterpreter) {
+    for(const auto& entry : std::filesystem::directory_iterator(MINT_EXAMPLES_DIR)) {
+        Mint::set_engine(engine_type::INTERPRETER);
+        std_stream.str("");
+        Mint::run_file(entry.path());
+        auto expected = std_stream.str();
+
+        Mint::set_engine(GetParam());
+        std_stream.str("");
+        Mint::run_file(entry.path());
+
+        ASSERT_EQ(std_stream.str(), expected) << entry.path();
+    }
+    ASSERT_EQ(err_stream.str(), "");
+}
+
+INSTANTIATE_TEST_SUITE_P(Engines, EngineTest,
+                         ::testing::Values(engine_type::INTERPRETER, engine_type::VM, engine_type::CLOSURE));
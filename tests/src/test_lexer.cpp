@@ -1,17 +1,19 @@
+#include <random>
 #include "gtest/gtest.h"
 #include "Lexer.h"
+#include "test_mint.h"
 
 TEST(LexerTest, TestScanTokens) {
     Lexer lx("let str = \"Hello, World\";");
     auto actual = lx.scan_tokens();
 
     const std::vector<Token> expected {
-        Token(token_type::LET, "let", std::string(""), 1),
-        Token(token_type::IDENTIFIER, "str", std::string(""), 1),
-        Token(token_type::EQUAL, "=", std::string(""), 1),
-        Token(token_type::STRING, "\"Hello, World\"", std::string("Hello, World"), 1),
-        Token(token_type::SEMICOLON, ";", std::string(""), 1),
-        Token(token_type::MINT_EOF, "", std::string(""), 1),
+        Token(token_type::LET, "let", {}, 1),
+        Token(token_type::IDENTIFIER, "str", {}, 1),
+        Token(token_type::EQUAL, "=", {}, 1),
+        Token(token_type::STRING, "\"Hello, World\"", std::string_view("Hello, World"), 1),
+        Token(token_type::SEMICOLON, ";", {}, 1),
+        Token(token_type::MINT_EOF, "", {}, 1),
 
     };
 
@@ -20,8 +22,71 @@ TEST(LexerTest, TestScanTokens) {
         ASSERT_EQ(expected[i].type, actual[i].type);
         ASSERT_EQ(expected[i].lexeme, actual[i].lexeme);
         ASSERT_EQ(expected[i].line, actual[i].line);
-        ASSERT_EQ(
-                std::any_cast<std::string>(expected[i].literal),
-                std::any_cast<std::string>(actual[i].literal));
+        ASSERT_EQ(expected[i].literal, actual[i].literal);
     }
-}
\ No newline at end of file
+    // The string literal points into the source
+    ASSERT_EQ(std::get<std::string_view>(actual[3].literal), "Hello, World");
+}
+
+TEST(LexerTest, TestKeywords) {
+    Lexer lx("function fun for fo false if iff let nil or print return true while whilst else f 1.5");
+    auto actual = lx.scan_tokens();
+
+    const std::vector<token_type> expected {
+        token_type::FN, token_type::IDENTIFIER, token_type::FOR, token_type::IDENTIFIER,
+        token_type::FALSE, token_type::IF, token_type::IDENTIFIER, token_type::LET,
+        token_type::NIL, token_type::OR, token_type::PRINT, token_type::RETURN,
+        token_type::TRUE, token_type::WHILE, token_type::IDENTIFIER, token_type::ELSE,
+        token_type::IDENTIFIER, token_type::NUMBER, token_type::MINT_EOF
+    };
+
+    ASSERT_EQ(actual.size(), expected.size());
+    for(auto i = 0UL; i < expected.size(); ++i)
+        ASSERT_EQ(expected[i], actual[i].type) << actual[i].lexeme;
+    ASSERT_EQ(std::get<double>(actual[17].literal), 1.5);
+}
+
+// Random programs full of the cases a chunk boundary can get wrong
+static auto random_source(std::mt19937& rng) -> std::string {
+    const std::vector<std::string> pieces = {
+        "let", " ", "  ", "\t", "\n", "\n\n", "x", "_long_name1", "function", "while", "42", "3.25",
+        "(", ")", "{", "}", ";", "+", "/", "//", "== ", "<<", "&&", "\"", "@", "# ",
+        "\"a string\"", "\"multi\nline\n\nstring // not a comment\"", "\"\"",
+        "// comment with \"quotes\" and / slashes\n", "// unterminated \" in comment\n", "/ /\n"
+    };
+    std::uniform_int_distribution<size_t> pick(0, pieces.size() - 1);
+    std::uniform_int_distribution<int> length(0, 400);
+
+    std::string source;
+    for(auto i = length(rng); i > 0; i--) source += pieces[pick(rng)];
+
+    return source;
+}
+
+class ParallelLexerTest : public MintTest {};
+
+TEST_F(ParallelLexerTest, TestMatchesSerialLexer) {
+    std::mt19937 rng(2022);
+    for(auto round = 0; round < 300; round++) {
+        auto source = random_source(rng);
+        err_stream.str("");
+        auto expected = Lexer(source).scan_tokens();
+        auto expected_errors = err_stream.str();
+
+        for(auto chunks : {2U, 3U, 8U, 64U}) {
+            err_stream.str("");
+            auto actual = Lexer::scan_tokens_parallel(source, chunks);
+
+            ASSERT_EQ(err_stream.str(), expected_errors) << source;
+            ASSERT_EQ(actual.size(), expected.size()) << source;
+            for(auto i = 0UL; i < expected.size(); ++i) {
+                ASSERT_EQ(actual[i].type, expected[i].type) << source;
+                ASSERT_EQ(actual[i].lexeme.data(), expected[i].lexeme.data()) << source;
+                ASSERT_EQ(actual[i].lexeme, expected[i].lexeme) << source;
+                ASSERT_EQ(actual[i].line, expected[i].line) << source;
+                ASSERT_EQ(actual[i].literal, expected[i].literal) << source;
+                ASSERT_EQ(actual[i].symbol, expected[i].symbol) << source;
+            }
+        }
+    }
+}
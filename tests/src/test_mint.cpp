@@ -1,6 +1,8 @@
 #include <fstream>
 #include "test_mint.h"
 #include "Token.h"
+#include "Memo.h"
+#include "Output.h"
 
 auto MintTest::SetUp() -> void {
     // Capture error output
@@ -12,11 +14,26 @@ auto MintTest::SetUp() -> void {
 }
 
 auto MintTest::TearDown() -> void {
+    // restore the default sink and flush policy before the streams
+    Output::redirect(-1);
     std::cerr.rdbuf(err_buf);
     std::cout.rdbuf(std_buf);
     // reset had_error and had_runtime_error flags
     Mint::had_error = false;
     Mint::had_runtime_error = false;
+    Mint::engine = engine_type::INTERPRETER;
+    Mint::optimization_level = 1;
+    Memo::set_capacity(0);
+}
+
+auto MintTest::eval(const std::string& source) -> std::string {
+    std::ofstream file(file_name, std::ios::trunc | std::ios::out | std::ios::binary);
+    file << source;
+    file.close();
+
+    Mint::run_file(file_name);
+
+    return std_stream.str();
 }
 
 TEST_F(MintTest, TestError) {
@@ -31,7 +48,7 @@ TEST_F(MintTest, TestError) {
 }
 
 TEST_F(MintTest, TestErrorWithEOFToken) {
-    auto eof_tk = Token(token_type::MINT_EOF, "", std::string(""), 1);
+    auto eof_tk = Token(token_type::MINT_EOF, "", {}, 1);
     Mint::error(eof_tk, "This is a test.");
 
     auto expected = "[Line 1] Error at end: This is a test.";
@@ -43,7 +60,7 @@ TEST_F(MintTest, TestErrorWithEOFToken) {
 }
 
 TEST_F(MintTest, TestErrorWithCommonToken) {
-    auto tk = Token(token_type::LET, "let", std::string(""), 1);
+    auto tk = Token(token_type::LET, "let", {}, 1);
     Mint::error(tk, "This is a test.");
 
     auto expected = "[Line 1] Error at 'let': This is a test.";
@@ -64,10 +81,26 @@ TEST_F(MintTest, TestSourceFileEvaluation) {
 
     ASSERT_EQ(res, 0);
 
-    auto expected = "120.000000";
+    auto expected = "120";
     auto actual = std_stream.str();
     // Remove trailing new line
     actual.erase(actual.length()-1);
 
     ASSERT_EQ(actual, expected);
+}
+
+TEST_F(MintTest, TestLocalSlots) {
+    auto actual = eval(
+            "let a = \"global\";\n"
+            "{\n"
+            "  let a = \"outer\";\n"
+            "  let b = \"b\";\n"
+            "  { let c = a + b; let a = \"inner\"; print a + c; }\n"
+            "  print a;\n"
+            "}\n"
+            "function make(x, y) { let z = x + y; function get() { return z; } return get; }\n"
+            "print make(\"1\", \"2\")();\n"
+            "print a;\n");
+
+    ASSERT_EQ(actual, "innerouterb\nouter\n12\nglobal\n");
 }
\ No newline at end of file
@@ -13,6 +13,7 @@ class MintTest : public ::testing::Test {
 protected:
     auto SetUp() -> void override;
     auto TearDown() -> void override;
+    auto eval(const std::string& source) -> std::string;
 
     std::streambuf *err_buf;
     std::streambuf *std_buf;
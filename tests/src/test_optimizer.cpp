@@ -0,0 +1,110 @@
+#include "test_mint.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "Resolver.h"
+#include "Optimizer.h"
+
+class OptimizerTest : public MintTest {
+protected:
+    // Parses, resolves and optimises a program
+    auto optimize(const std::string& text) -> Program {
+        source = std::make_unique<const Source>(text);
+        auto tokens = Lexer(source->text()).scan_tokens();
+        auto program = Parser(tokens).parse();
+        Resolver().resolve(program.statements);
+        Optimizer(program).optimize();
+
+        return program;
+    }
+
+    // Expression of the n-th print statement
+    static auto printed(const std::vector<Stmt*>& statements, size_t n) -> Expr* {
+        return dynamic_cast<Print*>(statements.at(n))->expression;
+    }
+
+    static auto literal(Expr* expr) -> Value {
+        auto lit = dynamic_cast<Literal*>(expr);
+        return lit != nullptr ? lit->value : Value::string("not a literal");
+    }
+
+    std::unique_ptr<const Source> source;
+};
+
+TEST_F(OptimizerTest, TestFolding) {
+    auto before = Optimizer::stats().folded;
+    auto program = optimize(
+            "print 1 + 2 * (3 - 1);\n"
+            "print \"Fizz\" + \"Buzz\";\n"
+            "print !(1 < 2) || 6 ^ 3;\n"
+            "print nil && undefined();\n"
+            "print \"a\" - 1;\n");
+
+    ASSERT_EQ(literal(printed(program.statements, 0)).as_integer(), 5);
+    ASSERT_EQ(literal(printed(program.statements, 1)).as_string(), "FizzBuzz");
+    ASSERT_EQ(literal(printed(program.statements, 2)).as_integer(), 5);
+    ASSERT_TRUE(literal(printed(program.statements, 3)).is_nil());
+    // Invalid operations are kept, so they still fail at runtime
+    ASSERT_NE(dynamic_cast<Binary*>(printed(program.statements, 4)), nullptr);
+    ASSERT_EQ(Optimizer::stats().folded - before, 9);
+}
+
+TEST_F(OptimizerTest, TestPropagation) {
+    auto before = Optimizer::stats().propagated;
+    auto program = optimize(
+            "let global = 1;\n"
+            "{\n"
+            "  let a = 2;\n"
+            "  let b = a * 3;\n"
+            "  let c = b;\n"
+            "  let unset;\n"
+            "  c = c + global;\n"
+            "  print b;\n"
+            "  print c;\n"
+            "  print unset;\n"
+            "}\n");
+    auto& block = dynamic_cast<Block&>(*program.statements.at(1));
+
+    ASSERT_EQ(literal(printed(block.statements, 5)).as_integer(), 6);
+    // Reassigned locals and globals are left alone
+    ASSERT_NE(dynamic_cast<Variable*>(printed(block.statements, 6)), nullptr);
+    ASSERT_TRUE(literal(printed(block.statements, 7)).is_nil());
+    ASSERT_EQ(Optimizer::stats().propagated - before, 4);
+}
+
+TEST_F(OptimizerTest, TestPruning) {
+    auto before = Optimizer::stats().pruned;
+    auto program = optimize(
+            "if(false) print 1; else print 2;\n"
+            "if(nil) print 3;\n"
+            "while(1 > 2) print 4;\n"
+            "function f(x) { if(x) { if(true) return 5; } else if(!true) return 6; return 7; }\n");
+
+    ASSERT_EQ(program.statements.size(), 2);
+    ASSERT_EQ(literal(printed(program.statements, 0)).as_integer(), 2);
+    ASSERT_EQ(Optimizer::stats().pruned - before, 5);
+}
+
+TEST_F(OptimizerTest, TestSameOutputAsUnoptimized) {
+    const std::string source =
+            "function apply(n) {\n"
+            "  let step = 2;\n"
+            "  let total = 0;\n"
+            "  for(let i = 0; i < n; i = i + step) {\n"
+            "    if(i % (step * 2) == 0 || false) total = total + i;\n"
+            "    else if(nil) total = -1;\n"
+            "  }\n"
+            "  return total + (true && \"!\" == \"!\");\n"
+            "}\n"
+            "print apply(10) + 1;\n"
+            "print \"a\" + (1 < 2 && 3);\n";
+
+    Mint::set_optimization_level(0);
+    auto expected = eval(source);
+    auto expected_errors = err_stream.str();
+    std_stream.str("");
+    err_stream.str("");
+    Mint::set_optimization_level(1);
+
+    ASSERT_EQ(eval(source), expected);
+    ASSERT_EQ(err_stream.str(), expected_errors);
+}
@@ -0,0 +1,46 @@
+#include <fcntl.h>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+#include "test_mint.h"
+#include "Output.h"
+
+TEST_F(MintTest, TestBlockBufferedOutput) {
+    Output::set_policy(flush_policy::BLOCK);
+    Output::print(Value::string("buffered"));
+    Output::print(1.5);
+    ASSERT_EQ(std_stream.str(), "");
+
+    Output::flush();
+    ASSERT_EQ(std_stream.str(), "buffered\n1.5\n");
+}
+
+TEST_F(MintTest, TestLineBufferedOutput) {
+    Output::set_policy(flush_policy::LINE);
+    Output::print(true);
+    ASSERT_EQ(std_stream.str(), "true\n");
+}
+
+TEST_F(MintTest, TestOutputFlushedBeforeErrors) {
+    Output::set_policy(flush_policy::BLOCK);
+    auto actual = eval("print 1; print nil; print -1 - nil;\n");
+
+    ASSERT_EQ(actual, "1\nnil\n");
+    ASSERT_EQ(err_stream.str(), "[Line 1] Operands must be numbers.\n");
+}
+
+TEST_F(MintTest, TestRedirectedOutput) {
+    const std::string path = "mint_output_test.txt";
+    auto fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    ASSERT_GE(fd, 0);
+
+    Output::redirect(fd);
+    eval("for(let i = 0; i < 3; i = i + 1) print i / 4;\n");
+    Output::redirect(-1);
+    close(fd);
+
+    std::stringstream written;
+    written << std::ifstream(path).rdbuf();
+    ASSERT_EQ(written.str(), "0\n0.25\n0.5\n");
+    ASSERT_EQ(std_stream.str(), "");
+}
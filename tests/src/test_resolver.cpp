@@ -0,0 +1,120 @@
+#include "test_mint.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "Resolver.h"
+#include "Memo.h"
+
+class ResolverTest : public MintTest {
+protected:
+    // Parses and resolves a program
+    auto resolve(const std::string& text) -> Program {
+        source = std::make_unique<const Source>(text);
+        auto tokens = Lexer(source->text()).scan_tokens();
+        auto program = Parser(tokens).parse();
+        Resolver().resolve(program.statements);
+
+        return program;
+    }
+
+    // Whether the global function with the given name is pure
+    static auto is_pure(const Program& program, const std::string& name) -> bool {
+        for(const auto& stmt : program.statements)
+            if(auto function = dynamic_cast<Function*>(stmt); function != nullptr && function->name.lexeme == name)
+                return function->pure;
+
+        throw std::invalid_argument(name);
+    }
+
+    std::unique_ptr<const Source> source;
+};
+
+TEST_F(ResolverTest, TestPureFunctions) {
+    auto program = resolve(
+            "function fib(n) { if(n <= 2) return n; return fib(n - 2) + fib(n - 1); }\n"
+            "function even(n) { if(n == 0) return true; return odd(n - 1); }\n"
+            "function odd(n) { if(n == 0) return false; return even(n - 1); }\n"
+            "function sum(n) { let total = 0; for(let i = 0; i < n; i = i + 1) total = total + fib(i); return total; }\n");
+
+    ASSERT_TRUE(is_pure(program, "fib"));
+    ASSERT_TRUE(is_pure(program, "even"));
+    ASSERT_TRUE(is_pure(program, "odd"));
+    ASSERT_TRUE(is_pure(program, "sum"));
+}
+
+TEST_F(ResolverTest, TestImpureFunctions) {
+    auto program = resolve(
+            "let offset = 1;\n"
+            "function logs(n) { print n; return n; }\n"
+            "function reads(n) { return n + offset; }\n"
+            "function writes(n) { offset = n; return n; }\n"
+            "function calls_impure(n) { return logs(n); }\n"
+            "function calls_value(f) { return f(1); }\n"
+            "function makes_closure() { let count = 0; function inc() { count = count + 1; return count; } return inc; }\n"
+            "function calls_later(n) { return later(n); }\n"
+            "function later(n) { return n; }\n"
+            "function later(n) { print n; return n; }\n"
+            "function calls_undefined(n) { return missing(n); }\n");
+
+    for(const auto& name : {"logs", "reads", "writes", "calls_impure", "calls_value", "makes_closure",
+                            "calls_later", "calls_undefined"})
+        ASSERT_FALSE(is_pure(program, name)) << name;
+}
+
+TEST_F(ResolverTest, TestNativeCalls) {
+    auto program = resolve(
+            "function hypot(a, b) { return sqrt(a * a + b * b); }\n"
+            "function elapsed(start) { return clock() - start; }\n"
+            "let floor = nil;\n"
+            "function rounds(n) { return floor(n); }\n");
+
+    ASSERT_TRUE(is_pure(program, "hypot"));
+    ASSERT_FALSE(is_pure(program, "elapsed"));
+    ASSERT_FALSE(is_pure(program, "rounds"));
+}
+
+TEST_F(ResolverTest, TestMemoisedCallsMatch) {
+    const std::string source =
+            "function fib(n) { if(n <= 2) return n; return fib(n - 2) + fib(n - 1); }\n"
+            "function label(n) { if(n % 2 == 0) return \"even\"; return \"odd\"; }\n"
+            "function noisy(n) { print \"called\"; return n; }\n"
+            "for(let i = 0; i < 25; i = i + 1) { fib(i); label(i); }\n"
+            "print fib(30);\n"
+            "print label(3) + label(-0) + label(0);\n"
+            "print noisy(1) + noisy(1);\n";
+
+    auto expected = eval(source);
+    std_stream.str("");
+    auto before = Memo::stats();
+    Memo::set_capacity(4);
+
+    ASSERT_EQ(eval(source), expected);
+    ASSERT_GT(Memo::stats().hits, before.hits);
+    ASSERT_GT(Memo::stats().evictions, before.evictions);
+}
+
+TEST_F(ResolverTest, TestMemoisedSignedZero) {
+    const std::string source =
+            "function inv(x) { return 1 / x; }\n"
+            "print inv(0.0); print inv(-0.0); print inv(0.0);\n";
+
+    auto expected = eval(source);
+    std_stream.str("");
+    Memo::set_capacity(10);
+
+    ASSERT_EQ(eval(source), expected);
+}
+
+TEST_F(ResolverTest, TestMemoisedNaN) {
+    const std::string source =
+            "function same(x) { return x == x; }\n"
+            "let nan = 0.0 / 0.0;\n"
+            "print same(nan); print same(nan);\n";
+
+    auto expected = eval(source);
+    std_stream.str("");
+    auto before = Memo::stats();
+    Memo::set_capacity(10);
+
+    ASSERT_EQ(eval(source), expected);
+    ASSERT_GT(Memo::stats().hits, before.hits);
+}
@@ -0,0 +1,65 @@
+#include <string>
+#include "Scanner.h"
+#include "Lexer.h"
+#include "gtest/gtest.h"
+
+// Runs of every length around the 16 and 32 byte blocks
+TEST(ScannerTest, TestSkipBlanks) {
+    for(auto length = 0; length < 80; length++) {
+        std::string text;
+        for(auto i = 0; i < length; i++) text += " \t\r\n"[i % 4];
+        text += "x  ";
+        unsigned int line = 1;
+
+        auto stop = Scanner::skip_blanks(text.data(), text.data() + text.size(), line);
+        ASSERT_EQ(stop - text.data(), length) << Scanner::isa();
+        ASSERT_EQ(line, 1 + length / 4) << length;
+    }
+}
+
+TEST(ScannerTest, TestSkipIdentifier) {
+    const std::string chars = "azAZ09_mintMINT";
+    for(auto length = 0; length < 80; length++) {
+        for(auto stop_char : {' ', '@', '[', '`', '{', '/', ':', '\x80', '('}) {
+            std::string text;
+            for(auto i = 0; i < length; i++) text += chars[i % chars.size()];
+            text += stop_char;
+
+            auto stop = Scanner::skip_identifier(text.data(), text.data() + text.size());
+            ASSERT_EQ(stop - text.data(), length) << int(stop_char);
+        }
+    }
+    std::string ident(50, 'a');
+    ASSERT_EQ(Scanner::skip_identifier(ident.data(), ident.data() + ident.size()), ident.data() + ident.size());
+}
+
+TEST(ScannerTest, TestFindQuote) {
+    for(auto length = 0; length < 80; length++) {
+        std::string text;
+        for(auto i = 0; i < length; i++) text += i % 5 == 0 ? '\n' : 'a';
+        auto unterminated = text;
+        text += "\"\n\n";
+        unsigned int line = 0;
+
+        auto stop = Scanner::find_quote(text.data(), text.data() + text.size(), line);
+        ASSERT_EQ(stop - text.data(), length);
+        ASSERT_EQ(line, (length + 4) / 5);
+
+        line = 0;
+        stop = Scanner::find_quote(unterminated.data(), unterminated.data() + unterminated.size(), line);
+        ASSERT_EQ(stop, unterminated.data() + unterminated.size());
+        ASSERT_EQ(line, (length + 4) / 5);
+    }
+}
+
+TEST(ScannerTest, TestLineNumbers) {
+    Lexer lx("let a = \"multi\nline\nstring\";\n\n   // comment\n\t\t  x 12.25;");
+    auto tokens = lx.scan_tokens();
+
+    ASSERT_EQ(tokens.size(), 9);
+    ASSERT_EQ(std::get<std::string_view>(tokens[3].literal), "multi\nline\nstring");
+    ASSERT_EQ(tokens[3].line, 3);
+    ASSERT_EQ(tokens[5].lexeme, "x");
+    ASSERT_EQ(tokens[5].line, 6);
+    ASSERT_EQ(std::get<double>(tokens[6].literal), 12.25);
+}
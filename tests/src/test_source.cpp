@@ -0,0 +1,34 @@
+#include <fstream>
+#include <string>
+#include "Source.h"
+#include "gtest/gtest.h"
+
+TEST(SourceTest, TestMappedFile) {
+    const std::string path = "mint_source_test.js";
+    std::ofstream(path, std::ios::binary) << "print \"mapped\";\n";
+
+    auto source = Source::from_file(path);
+    ASSERT_NE(source, nullptr);
+    ASSERT_EQ(source->text(), "print \"mapped\";\n");
+}
+
+TEST(SourceTest, TestEmptyFile) {
+    const std::string path = "mint_empty_test.js";
+    std::ofstream(path, std::ios::trunc);
+
+    auto source = Source::from_file(path);
+    ASSERT_NE(source, nullptr);
+    ASSERT_TRUE(source->text().empty());
+}
+
+TEST(SourceTest, TestUnreadableFiles) {
+    ASSERT_EQ(Source::from_file("/nonexistent/script.js"), nullptr);
+    // Directories can be opened but not read
+    ASSERT_EQ(Source::from_file("/"), nullptr);
+}
+
+TEST(SourceTest, TestInMemorySource) {
+    Source source(std::string("let x = 1;"));
+
+    ASSERT_EQ(source.text(), "let x = 1;");
+}
@@ -2,16 +2,16 @@
 #include "gtest/gtest.h"
 
 TEST(TokenTest, TestCtor) {
-    Token tk(token_type::LEFT_PAREN, "(", std::string("("), 0);
+    Token tk(token_type::LEFT_PAREN, "(", {}, 0);
 
     ASSERT_EQ(tk.type, token_type::LEFT_PAREN);
     ASSERT_EQ(tk.lexeme, "(");
-    ASSERT_EQ(std::any_cast<std::string>(tk.literal), std::string("("));
+    ASSERT_TRUE(std::holds_alternative<std::monostate>(tk.literal));
     ASSERT_EQ(tk.line, 0);
 }
 
 TEST(TokenTest, TestToString) {
-    Token tk(token_type::LEFT_PAREN, "(", std::string("("), 0);
+    Token tk(token_type::LEFT_PAREN, "(", {}, 0);
     auto expected = std::string( std::to_string((double)0.0) + " ( nil");
     auto actual = tk.to_string();
 
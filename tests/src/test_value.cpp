@@ -0,0 +1,116 @@
+#include <cmath>
+#include <limits>
+#include "Value.h"
+#include "Interner.h"
+#include "Operators.h"
+#include "gtest/gtest.h"
+
+TEST(ValueTest, TestInlineTypes) {
+    Value nil;
+    Value boolean(true);
+    Value number(42.5);
+
+    ASSERT_TRUE(nil.is_nil());
+    ASSERT_TRUE(boolean.is_bool());
+    ASSERT_TRUE(boolean.as_bool());
+    ASSERT_TRUE(number.is_number());
+    ASSERT_EQ(number.as_number(), 42.5);
+    ASSERT_FALSE(number.is_object());
+}
+
+TEST(ValueTest, TestIntegerArithmetic) {
+    constexpr auto max = std::numeric_limits<int64_t>::max();
+    constexpr auto min = std::numeric_limits<int64_t>::min();
+
+    ASSERT_EQ(Operators::add(40, 2).as_integer(), 42);
+    ASSERT_EQ(Operators::multiply(-3, 7).as_integer(), -21);
+    ASSERT_EQ(Operators::modulo(-7, 3).as_integer(), -1);
+    // Overflowing results are promoted to doubles
+    ASSERT_TRUE(Operators::add(max, 1).is_number());
+    ASSERT_EQ(Operators::add(max, 1).as_number(), 9223372036854775808.0);
+    ASSERT_TRUE(Operators::subtract(min, 1).is_number());
+    ASSERT_TRUE(Operators::multiply(max, 2).is_number());
+    ASSERT_TRUE(Operators::negate(min).is_number());
+    // So are the negative zeros doubles would produce
+    ASSERT_TRUE(std::signbit(Operators::negate(0).as_number()));
+    ASSERT_TRUE(std::signbit(Operators::multiply(0, -5).as_number()));
+    ASSERT_TRUE(std::signbit(Operators::modulo(-4, 2).as_number()));
+    ASSERT_TRUE(std::isnan(Operators::modulo(1, 0).as_number()));
+    ASSERT_EQ(Operators::modulo(min, -1).as_number(), 0);
+    ASSERT_TRUE(Operators::divide(7, 2).is_number());
+    ASSERT_EQ(Operators::shift_left(1, 65).as_integer(), 2);
+    ASSERT_EQ(Operators::shift_right(-16, 2).as_integer(), -4);
+}
+
+TEST(ValueTest, TestIntegerConversions) {
+    ASSERT_EQ(Operators::to_integer(Value(int64_t{-5})), -5);
+    ASSERT_EQ(Operators::to_integer(-2.75), -2);
+    ASSERT_EQ(Operators::to_integer(18446744073709551617.0), 0);
+    ASSERT_EQ(Operators::to_integer(std::nan("")), 0);
+    ASSERT_TRUE(Operators::is_equal(Value(int64_t{3}), 3.0));
+    ASSERT_FALSE(Operators::is_equal(Value(int64_t{3}), 3.5));
+    ASSERT_EQ(Operators::stringify(Value(int64_t{-120})), "-120");
+    ASSERT_EQ(Operators::stringify(Value(int64_t{9007199254740993})), "9007199254740993");
+}
+
+TEST(ValueTest, TestNumberFormatting) {
+    ASSERT_EQ(Operators::stringify(120.0), "120");
+    ASSERT_EQ(Operators::stringify(0.1), "0.1");
+    ASSERT_EQ(Operators::stringify(-2.5), "-2.5");
+    ASSERT_EQ(Operators::stringify(1.0 / 3.0), "0.3333333333333333");
+    ASSERT_EQ(Operators::stringify(1e21), "1e+21");
+    ASSERT_EQ(Operators::stringify(-0.0), "-0");
+    ASSERT_EQ(Operators::stringify(Value(int64_t{-42})), "-42");
+}
+
+TEST(ValueTest, TestStringHandleIsShared) {
+    auto str = Value::string("Hello, World");
+    auto copy = str;
+
+    ASSERT_TRUE(copy.is_string());
+    ASSERT_EQ(copy.as_string(), "Hello, World");
+    ASSERT_EQ(str.as_object(), copy.as_object());
+    ASSERT_EQ(str.as_object()->ref_count, 2);
+}
+
+TEST(ValueTest, TestReassignmentReleasesObject) {
+    auto str = Value::string("foo");
+    auto copy = str;
+
+    copy = 1.0;
+    ASSERT_TRUE(copy.is_number());
+    ASSERT_EQ(str.as_object()->ref_count, 1);
+
+    auto moved = std::move(str);
+    ASSERT_TRUE(str.is_nil());
+    ASSERT_EQ(moved.as_object()->ref_count, 1);
+}
+
+TEST(ValueTest, TestInternedStringsAreUnique) {
+    auto a = Interner::intern("FizzBuzz");
+    auto b = Interner::intern(std::string("Fizz") + "Buzz");
+    auto c = Interner::intern("Fizz");
+
+    ASSERT_EQ(a.as_object(), b.as_object());
+    ASSERT_NE(a.as_object(), c.as_object());
+    ASSERT_EQ(Interner::symbol("FizzBuzz"), a.as_object<MintString>());
+    ASSERT_TRUE(Operators::is_equal(a, b));
+    ASSERT_FALSE(Operators::is_equal(a, c));
+    // Strings built at runtime are not interned, but still compare by contents
+    ASSERT_TRUE(Operators::is_equal(a, Value::string("FizzBuzz")));
+}
+
+TEST(ValueTest, TestConcatenationSharesPrefixes) {
+    auto base = Value::string("ab");
+    auto left = Value(MintString::concat(base.as_object<MintString>(), Interner::symbol("c")));
+    auto right = Value(MintString::concat(base.as_object<MintString>(), Interner::symbol("d")));
+    auto twice = Value(MintString::concat(left.as_object<MintString>(), left.as_object<MintString>()));
+    auto longer = Value(MintString::concat(left.as_object<MintString>(), Interner::symbol("e")));
+
+    ASSERT_EQ(base.as_string(), "ab");
+    ASSERT_EQ(left.as_string(), "abc");
+    ASSERT_EQ(right.as_string(), "abd");
+    ASSERT_EQ(twice.as_string(), "abcabc");
+    ASSERT_EQ(longer.as_string(), "abce");
+    ASSERT_FALSE(Operators::is_equal(left, longer));
+}